@@ -0,0 +1,110 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef MPM_COLLIDER_H
+#define MPM_COLLIDER_H
+
+#include <mpm/Global.h>
+#include <mpm/TriangleMesh.h>
+#include <mpm/VolumeCache.h>
+#include <mpm/TriangleBvh.h>
+
+#include <glm/vec3.hpp>
+
+#include <openvdb/openvdb.h>
+
+#include <vector>
+
+MPM_NAMESPACE_BEGIN
+
+enum class Contact {
+    Sticky,
+    Slip,
+    Separate
+};
+
+class Collider {
+private:
+    openvdb::FloatGrid::ConstPtr volume;
+    openvdb::FloatGrid::Ptr meshVolume;
+    std::vector<glm::vec3> references;
+    std::vector<uint32_t> adjacencyOffsets;
+    std::vector<uint32_t> adjacentTriangles;
+    TriangleBvh bvh;
+    float voxelSize;
+    glm::vec3 lower;
+    glm::vec3 upper;
+    glm::vec3 translation;
+    glm::vec3 velocity;
+    Contact contact;
+    float friction;
+
+    Collider & computeBounds();
+    Collider & track(const TriangleMesh *, float, openvdb::FloatGrid::Ptr);
+
+public:
+    class Sampler {
+    private:
+        const Collider * collider;
+        openvdb::FloatGrid::ConstAccessor accessor;
+
+    public:
+        Sampler(const Collider &);
+
+        bool apply(const glm::vec3 &, glm::vec3 &);
+    };
+
+    Collider();
+    Collider(const TriangleMesh *, float, Contact = Contact::Slip, const VolumeCache * = nullptr);
+    Collider(openvdb::FloatGrid::ConstPtr, Contact = Contact::Slip);
+    Collider(const Collider &);
+    ~Collider();
+
+    Collider & operator=(const Collider &);
+
+    Collider & create(const TriangleMesh *, float, const VolumeCache * = nullptr);
+    Collider & update(const TriangleMesh *, float);
+    Collider & advance(float);
+
+    Collider & setVolume(openvdb::FloatGrid::ConstPtr);
+    Collider & setTranslation(const glm::vec3 &);
+    Collider & setVelocity(const glm::vec3 &);
+    Collider & setContact(Contact);
+    Collider & setFriction(float);
+
+    openvdb::FloatGrid::ConstPtr getVolume() const;
+    const glm::vec3 & getTranslation() const;
+    const glm::vec3 & getVelocity() const;
+    Contact getContact() const;
+    float getFriction() const;
+    bool overlaps(const glm::vec3 &, const glm::vec3 &) const;
+    bool empty() const;
+};
+
+MPM_NAMESPACE_END
+
+#endif
@@ -0,0 +1,79 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef MPM_COMPACT_TRIANGLE_MESH_H
+#define MPM_COMPACT_TRIANGLE_MESH_H
+
+#include <mpm/Global.h>
+#include <mpm/TriangleMesh.h>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+#include <vector>
+#include <cstdint>
+
+MPM_NAMESPACE_BEGIN
+
+class CompactTriangleMesh {
+public:
+    class Vertex {
+    public:
+        glm::vec3 position;
+        glm::vec3 normal;
+        glm::vec2 textureCoordinates;
+    };
+
+private:
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    bool withNormals;
+    bool withTextureCoordinates;
+
+public:
+    CompactTriangleMesh();
+    CompactTriangleMesh(const TriangleMesh &);
+    ~CompactTriangleMesh();
+
+    CompactTriangleMesh & create(const TriangleMesh &);
+    CompactTriangleMesh & clear();
+    TriangleMesh * expand() const;
+
+    const std::vector<Vertex> & getVertices() const;
+    const std::vector<uint32_t> & getIndices() const;
+    const Vertex & getVertex(size_t) const;
+    void getIndices(size_t, uint32_t &, uint32_t &, uint32_t &) const;
+    size_t getVertexCount() const;
+    size_t getTriangleCount() const;
+    bool hasNormals() const;
+    bool hasTextureCoordinates() const;
+    bool empty() const;
+};
+
+MPM_NAMESPACE_END
+
+#endif
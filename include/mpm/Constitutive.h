@@ -0,0 +1,72 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef MPM_CONSTITUTIVE_H
+#define MPM_CONSTITUTIVE_H
+
+#include <mpm/Global.h>
+#include <mpm/Kernel.h>
+
+#include <cstddef>
+
+MPM_NAMESPACE_BEGIN
+
+enum class ConstitutiveModel {
+    NeoHookean,
+    FixedCorotated
+};
+
+struct SvdBatch {
+    alignas(64) float matrices[9][KERNEL_BATCH_SIZE];
+    alignas(64) float u[9][KERNEL_BATCH_SIZE];
+    alignas(64) float sigma[3][KERNEL_BATCH_SIZE];
+    alignas(64) float v[9][KERNEL_BATCH_SIZE];
+};
+
+struct StressBatch {
+    alignas(64) float deformationGradients[9][KERNEL_BATCH_SIZE];
+    alignas(64) float lambdas[KERNEL_BATCH_SIZE];
+    alignas(64) float mus[KERNEL_BATCH_SIZE];
+    alignas(64) float stresses[9][KERNEL_BATCH_SIZE];
+};
+
+struct PlasticityBatch {
+    alignas(64) float deformationGradients[9][KERNEL_BATCH_SIZE];
+    alignas(64) float yieldStrains[KERNEL_BATCH_SIZE];
+    alignas(64) float relaxations[KERNEL_BATCH_SIZE];
+};
+
+class Constitutive {
+public:
+    static void computeSvd(SvdBatch &, size_t);
+    static void computeStresses(ConstitutiveModel, StressBatch &, size_t);
+    static void computeReturnMapping(PlasticityBatch &, size_t);
+};
+
+MPM_NAMESPACE_END
+
+#endif
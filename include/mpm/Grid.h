@@ -0,0 +1,173 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef MPM_GRID_H
+#define MPM_GRID_H
+
+#include <mpm/Global.h>
+#include <mpm/Kernel.h>
+#include <mpm/Span.h>
+
+#include <glm/vec3.hpp>
+
+#include <tbb/enumerable_thread_specific.h>
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+MPM_NAMESPACE_BEGIN
+
+class Grid {
+public:
+    static const int BLOCK_VOLUME = 64;
+
+    // Blocks are 4x4x4 nodes in 3D and 8x8x1 nodes in 2D, where only one
+    // layer of nodes is ever touched.
+    template <int dimension>
+    class Layout {
+    public:
+        static const int BITS = dimension == 3 ? 2 : 3;
+        static const int DEPTH_BITS = dimension == 3 ? BITS : 0;
+        static const int MASK = (1 << BITS) - 1;
+        static const int DEPTH_MASK = (1 << DEPTH_BITS) - 1;
+
+        static size_t getNodeIndex(int x, int y, int z) {
+            return (((x << BITS) | y) << DEPTH_BITS) | z;
+        }
+        static glm::ivec3 getNodeCoordinate(size_t i) {
+            return glm::ivec3(i >> (BITS + DEPTH_BITS), (i >> DEPTH_BITS) & MASK, i & DEPTH_MASK);
+        }
+        static glm::ivec3 getBlockCoordinate(const glm::ivec3 & node) {
+            return glm::ivec3(node.x >> BITS, node.y >> BITS, node.z >> DEPTH_BITS);
+        }
+        static glm::ivec3 getBlockSize() {
+            return glm::ivec3(1 << BITS, 1 << BITS, 1 << DEPTH_BITS);
+        }
+        static glm::ivec3 getCoarseningRatio() {
+            return glm::ivec3(2, 2, dimension == 3 ? 2 : 1);
+        }
+    };
+
+    class Block {
+    public:
+        glm::ivec3 coordinate;
+        size_t index;
+        float mass[BLOCK_VOLUME];
+        glm::vec3 momentum[BLOCK_VOLUME];
+        glm::vec3 velocity[BLOCK_VOLUME];
+
+        Block & clear();
+        Block & accumulate(const Block &);
+    };
+
+    class Neighborhood {
+    public:
+        Block * blocks[8];
+
+        Neighborhood();
+
+        Neighborhood & fetch(const Grid &, const glm::ivec3 &);
+
+        template <int dimension>
+        Block * getBlock(int x, int y, int z) const {
+            return blocks[((x >> Layout<dimension>::BITS) << 2)
+                | ((y >> Layout<dimension>::BITS) << 1) | (z >> Layout<dimension>::DEPTH_BITS)];
+        }
+        template <int dimension>
+        static size_t getNode(int x, int y, int z) {
+            return Layout<dimension>::getNodeIndex(x & Layout<dimension>::MASK,
+                y & Layout<dimension>::MASK, z & Layout<dimension>::DEPTH_MASK);
+        }
+    };
+
+    class LocalBuffer {
+    public:
+        LocalBuffer();
+
+        LocalBuffer & reset(size_t);
+        LocalBuffer & redirect(const Grid &, Neighborhood &);
+
+        const Block * findBlock(size_t) const;
+
+    private:
+        std::vector<int32_t> slots;
+        std::vector<std::unique_ptr<Block>> blocks;
+        size_t blockCount;
+
+        Block & getBlock(const Block &);
+    };
+
+    Grid();
+    ~Grid();
+
+    Grid & activate(Span<const glm::vec3>, Interpolation);
+    Grid & coarsen(const Grid &, Span<const float>);
+    Grid & clear();
+    Grid & reduce(const std::vector<const LocalBuffer *> &);
+
+    Block * findBlock(const glm::ivec3 &) const;
+    Block & getBlock(size_t);
+    const Block & getBlock(size_t) const;
+    glm::vec3 getPosition(const Block &, size_t) const;
+
+    Grid & setSpacing(float);
+    Grid & setDimension(int);
+
+    float getSpacing() const;
+    int getDimension() const;
+    size_t getBlockCount() const;
+    size_t getBlockCapacity() const;
+    size_t getNodeCount() const;
+
+    glm::ivec3 getBlockSize() const;
+    glm::ivec3 getCoarseningRatio() const;
+    size_t getNodeIndex(const glm::ivec3 &) const;
+    glm::ivec3 getNodeCoordinate(size_t) const;
+    glm::ivec3 getBlockCoordinate(const glm::ivec3 &) const;
+
+private:
+    float spacing;
+    int dimension;
+
+    std::vector<std::unique_ptr<Block>> blocks;
+    size_t blockCount;
+
+    std::vector<uint64_t> tableKeys;
+    std::vector<uint32_t> tableValues;
+    uint64_t tableMask;
+
+    static uint64_t getKey(const glm::ivec3 &);
+    static uint64_t getHash(uint64_t);
+
+    Grid & allocate(tbb::enumerable_thread_specific<std::vector<uint64_t>> &);
+    Grid & buildTable();
+};
+
+MPM_NAMESPACE_END
+
+#endif
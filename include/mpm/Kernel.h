@@ -0,0 +1,82 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef MPM_KERNEL_H
+#define MPM_KERNEL_H
+
+#include <mpm/Global.h>
+
+#include <cstddef>
+
+#if !defined(_MSC_VER) || _MSC_VER >= 1911
+#define MPM_AVX512_KERNEL
+#endif
+
+MPM_NAMESPACE_BEGIN
+
+static const size_t KERNEL_BATCH_SIZE = 64;
+static const size_t KERNEL_STENCIL_SIZE = 4;
+
+enum class InstructionSet {
+    Scalar,
+    Avx2,
+    Avx512
+};
+
+enum class Interpolation {
+    Linear,
+    Quadratic,
+    Cubic
+};
+
+template <Interpolation interpolation>
+struct Stencil {
+    static const int SIZE = interpolation == Interpolation::Linear ? 2
+        : interpolation == Interpolation::Quadratic ? 3 : 4;
+};
+
+struct KernelBatch {
+    alignas(64) int bases[3][KERNEL_BATCH_SIZE];
+    alignas(64) float weights[3][KERNEL_STENCIL_SIZE][KERNEL_BATCH_SIZE];
+    alignas(64) float gradients[3][KERNEL_STENCIL_SIZE][KERNEL_BATCH_SIZE];
+};
+
+class Kernel {
+public:
+    static InstructionSet getSupportedInstructionSet();
+    static InstructionSet getInstructionSet();
+    static InstructionSet setInstructionSet(InstructionSet);
+
+    static size_t getStencilSize(Interpolation);
+    static float getStencilOffset(Interpolation);
+
+    static void computeWeights(Interpolation, const float *, size_t, float, KernelBatch &);
+};
+
+MPM_NAMESPACE_END
+
+#endif
@@ -0,0 +1,75 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef MPM_MATERIAL_H
+#define MPM_MATERIAL_H
+
+#include <mpm/Global.h>
+
+#include <glm/vec3.hpp>
+
+MPM_NAMESPACE_BEGIN
+
+enum class PlasticityModel {
+    None,
+    Maxwell,
+    Viscoplastic
+};
+
+class Material {
+public:
+    Material();
+    Material(const glm::vec3 &, float, float, float);
+
+    Material & setPlasticityModel(PlasticityModel);
+    Material & setRelaxationTime(float);
+    Material & setYieldStrain(float);
+
+    const glm::vec3 & getVelocity() const;
+    float getMass() const;
+    float getLambda() const;
+    float getMu() const;
+    PlasticityModel getPlasticityModel() const;
+    float getRelaxationTime() const;
+    float getYieldStrain() const;
+
+    bool operator==(const Material &) const;
+    bool operator!=(const Material &) const;
+
+private:
+    glm::vec3 velocity;
+    float mass;
+    float lambda;
+    float mu;
+    PlasticityModel plasticityModel;
+    float relaxationTime;
+    float yieldStrain;
+};
+
+MPM_NAMESPACE_END
+
+#endif
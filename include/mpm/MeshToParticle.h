@@ -30,22 +30,32 @@
 
 #include <mpm/Global.h>
 #include <mpm/TriangleMesh.h>
+#include <mpm/Material.h>
+#include <mpm/ParticleSystem.h>
+#include <mpm/VolumeCache.h>
 
 #include <glm/vec3.hpp>
 
 #include <openvdb/openvdb.h>
 
 #include <vector>
-#include <random>
 
 MPM_NAMESPACE_BEGIN
 
-using RandomGenerator = std::mersenne_twister_engine<uint32_t, 32, 351, 175, 19,
-    0xccab8ee7, 11, 0xffffffff, 7, 0x31b6ab00, 15, 0xffe50000, 17, 1812433253>;
+enum class Sampling {
+    Uniform,
+    Stratified
+};
+
+enum class Voxelization {
+    Dense,
+    Sparse,
+    Raycast
+};
 
 class MeshDataAdapter {
 public:
-    MeshDataAdapter(TriangleMesh *, float);
+    MeshDataAdapter(const TriangleMesh *, float);
 
     size_t pointCount() const;
     size_t polygonCount() const;
@@ -53,57 +63,25 @@ public:
 
     void getIndexSpacePoint(size_t, size_t, openvdb::math::Vec3d &) const;
 
-    TriangleMesh * getMesh();
+    const TriangleMesh * getMesh() const;
     const openvdb::math::Transform & getTransform() const;
 
 private:
-    TriangleMesh * mesh;
+    const TriangleMesh * mesh;
     openvdb::math::Transform::Ptr transform;
 };
 
-class Material {
-public:
-    Material(const glm::vec3 &, float, float, float);
-
-    const glm::vec3 & getVelocity() const;
-    float getMass() const;
-    float getLambda() const;
-    float getMu() const;
-
-private:
-    glm::vec3 velocity;
-    float mass;
-    float lambda;
-    float mu;
-};
-
-class Particle {
-public:
-    Particle();
-    Particle(const Material &);
-
-    glm::vec3 position;
-    glm::vec3 velocity;
-    float mass;
-    float volume;
-    float lambda;
-    float mu;
-
-    Particle & apply(const Material &);
-};
-
-typedef std::vector<Particle *> ParticlePointerArray;
-
 class MeshToParticle {
 public:
-    MeshToParticle(TriangleMesh *, const Material &, float, float, float, size_t);
+    MeshToParticle(const TriangleMesh *, const Material &, float, float, float, size_t,
+        Sampling = Sampling::Uniform, Voxelization = Voxelization::Dense,
+        const VolumeCache * = nullptr);
     ~MeshToParticle();
 
-    ParticlePointerArray & getParticles();
-    void add(const openvdb::Vec3d &);
+    ParticleSystem & getParticles();
 
 private:
-    ParticlePointerArray particles;
+    ParticleSystem particles;
 };
 
 MPM_NAMESPACE_END
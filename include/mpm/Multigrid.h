@@ -0,0 +1,93 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#ifndef MPM_MULTIGRID_H
+#define MPM_MULTIGRID_H
+
+#include <mpm/Global.h>
+#include <mpm/Grid.h>
+#include <mpm/Span.h>
+
+#include <glm/vec3.hpp>
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+MPM_NAMESPACE_BEGIN
+
+class Multigrid {
+private:
+    class Level {
+    public:
+        Grid coarseGrid;
+        const Grid * grid;
+        float coupling;
+
+        std::vector<int32_t> neighbors;
+        std::vector<float> masses;
+        std::vector<float> diagonals;
+        std::vector<glm::vec3> solutions;
+        std::vector<glm::vec3> rightHandSides;
+        std::vector<glm::vec3> residuals;
+    };
+
+    std::vector<std::unique_ptr<Level>> levels;
+    Span<const uint8_t> constraints;
+    std::vector<uint32_t> coarseNodes;
+    std::vector<double> coarseFactor;
+    std::vector<double> coarseValues;
+    size_t levelCount;
+    size_t maximumLevels;
+    size_t smoothingSteps;
+
+    Multigrid & connect(Level &);
+    Multigrid & factorize();
+    Multigrid & solveCoarsest();
+    Multigrid & computeResiduals(size_t);
+    Multigrid & smooth(size_t, size_t);
+    Multigrid & restrictResiduals(size_t);
+    Multigrid & prolongateSolutions(size_t);
+    Multigrid & cycle(size_t);
+
+public:
+    Multigrid();
+    ~Multigrid();
+
+    Multigrid & build(const Grid &, Span<const float>, Span<const uint8_t>, float);
+    Multigrid & apply(Span<const glm::vec3>, Span<glm::vec3>);
+
+    Multigrid & setMaximumLevels(size_t);
+    Multigrid & setSmoothingSteps(size_t);
+
+    size_t getMaximumLevels() const;
+    size_t getSmoothingSteps() const;
+    size_t getLevelCount() const;
+};
+
+MPM_NAMESPACE_END
+
+#endif
@@ -0,0 +1,70 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef MPM_PARTICLE_SORTER_H
+#define MPM_PARTICLE_SORTER_H
+
+#include <mpm/Global.h>
+#include <mpm/Kernel.h>
+#include <mpm/ParticleSystem.h>
+
+#include <glm/vec3.hpp>
+
+#include <vector>
+#include <cstdint>
+
+MPM_NAMESPACE_BEGIN
+
+class ParticleSorter {
+private:
+    std::vector<uint64_t> keys;
+    std::vector<uint64_t> swapKeys;
+    std::vector<uint32_t> indices;
+    std::vector<uint32_t> swapIndices;
+    std::vector<uint32_t> keptIndices;
+    std::vector<uint32_t> nextIndices;
+    std::vector<uint32_t> displacedIndices;
+
+    ParticleSorter & computeKeys(Span<const glm::vec3>, float, Interpolation, int);
+    size_t countDescents() const;
+    bool repair(size_t);
+    ParticleSorter & radixSort();
+
+public:
+    ParticleSorter();
+    ~ParticleSorter();
+
+    bool sort(ParticleSystem &, float, Interpolation, int);
+
+    Span<const uint64_t> getKeys() const;
+
+    static uint64_t getMortonCode(const glm::ivec3 &);
+};
+
+MPM_NAMESPACE_END
+
+#endif
@@ -0,0 +1,97 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef MPM_PARTICLE_SYSTEM_H
+#define MPM_PARTICLE_SYSTEM_H
+
+#include <mpm/Global.h>
+#include <mpm/Material.h>
+#include <mpm/Span.h>
+
+#include <glm/vec3.hpp>
+#include <glm/mat3x3.hpp>
+
+#include <tbb/cache_aligned_allocator.h>
+
+#include <vector>
+#include <cstdint>
+
+MPM_NAMESPACE_BEGIN
+
+template <typename T>
+using AlignedArray = std::vector<T, tbb::cache_aligned_allocator<T>>;
+
+class ParticleSystem {
+private:
+    AlignedArray<glm::vec3> positions;
+    AlignedArray<glm::vec3> velocities;
+    AlignedArray<float> volumes;
+    AlignedArray<glm::mat3> affines;
+    AlignedArray<glm::mat3> deformationGradients;
+    AlignedArray<uint16_t> materials;
+
+    std::vector<Material> materialTable;
+
+    bool addMaterial(const Material &, uint16_t &);
+
+public:
+    ParticleSystem();
+    ~ParticleSystem();
+
+    ParticleSystem & reserve(size_t);
+    ParticleSystem & resize(size_t);
+    ParticleSystem & clear();
+
+    bool append(const ParticleSystem &);
+    bool append(const glm::vec3 *, size_t, const Material &, float);
+    ParticleSystem & permute(Span<const uint32_t>);
+
+    ParticleSystem & setMaterial(uint16_t, const Material &);
+
+    Span<glm::vec3> getPositions();
+    Span<glm::vec3> getVelocities();
+    Span<float> getVolumes();
+    Span<glm::mat3> getAffines();
+    Span<glm::mat3> getDeformationGradients();
+    Span<uint16_t> getMaterials();
+
+    Span<const glm::vec3> getPositions() const;
+    Span<const glm::vec3> getVelocities() const;
+    Span<const float> getVolumes() const;
+    Span<const glm::mat3> getAffines() const;
+    Span<const glm::mat3> getDeformationGradients() const;
+    Span<const uint16_t> getMaterials() const;
+    Span<const Material> getMaterialTable() const;
+    const Material & getMaterial(uint16_t) const;
+
+    size_t getParticleCount() const;
+    bool empty() const;
+};
+
+MPM_NAMESPACE_END
+
+#endif
@@ -0,0 +1,223 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef MPM_SOLVER_H
+#define MPM_SOLVER_H
+
+#include <mpm/Global.h>
+#include <mpm/Grid.h>
+#include <mpm/Kernel.h>
+#include <mpm/Constitutive.h>
+#include <mpm/Multigrid.h>
+#include <mpm/ParticleSystem.h>
+#include <mpm/ParticleSorter.h>
+#include <mpm/Collider.h>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/mat3x3.hpp>
+
+#include <tbb/task_arena.h>
+#include <tbb/enumerable_thread_specific.h>
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+MPM_NAMESPACE_BEGIN
+
+enum class ScatterStrategy {
+    Coloring,
+    ThreadLocal
+};
+
+enum class Integration {
+    Explicit,
+    Implicit
+};
+
+enum class Preconditioner {
+    Diagonal,
+    Multigrid
+};
+
+class Solver {
+private:
+    typedef std::pair<size_t, size_t> Partition;
+
+    ParticleSystem particles;
+    ParticleSorter sorter;
+    Grid grid;
+    std::vector<Collider> colliders;
+
+    std::vector<Partition> partitions[8];
+    tbb::enumerable_thread_specific<Grid::LocalBuffer> localBuffers;
+
+    float gridSpacing;
+    float timeStep;
+    glm::vec3 gravity;
+    glm::vec3 minimumBound;
+    glm::vec3 maximumBound;
+    size_t threadCount;
+    bool sorting;
+    ScatterStrategy scatterStrategy;
+    Interpolation interpolation;
+    int dimension;
+    ConstitutiveModel constitutiveModel;
+
+    float cflNumber;
+    float minimumTimeStep;
+    float maximumTimeStep;
+    size_t maximumSubsteps;
+    size_t substepCount;
+    float substepSize;
+    float maximumSpeed;
+    float maximumWaveSpeed;
+    bool measured;
+
+    Integration integration;
+    size_t newtonIterations;
+    size_t krylovIterations;
+    float newtonTolerance;
+    float krylovTolerance;
+    Preconditioner preconditioner;
+    size_t newtonIterationCount;
+    size_t krylovIterationCount;
+
+    AlignedArray<glm::mat3> trialDeformationGradients;
+    AlignedArray<float> nodeMasses;
+    AlignedArray<uint8_t> nodeConstraints;
+    AlignedArray<glm::vec3> nodeTargets;
+    AlignedArray<glm::vec3> nodeVelocities;
+    AlignedArray<glm::vec3> nodeGradients;
+    AlignedArray<glm::vec3> nodeResiduals;
+    AlignedArray<glm::vec3> nodePreconditioned;
+    AlignedArray<glm::vec3> nodeSteps;
+    AlignedArray<glm::vec3> nodeDirections;
+    AlignedArray<glm::vec3> nodeProducts;
+    Multigrid multigrid;
+
+    tbb::task_arena arena;
+
+    Solver & measure();
+    Solver & substep(float);
+    Solver & rasterize();
+    Solver & partition();
+    template <typename Function> Solver & transfer(const Function &);
+    template <Interpolation, int> Solver & particleToGrid();
+    template <int> Solver & updateGrid();
+    template <int> Solver & collide();
+    template <Interpolation, int, typename Compute> Solver & exchangeNodes(
+        const AlignedArray<glm::vec3> &, AlignedArray<glm::vec3> &, const Compute &);
+    template <Interpolation, int> double computeForces(
+        const AlignedArray<glm::vec3> &, AlignedArray<glm::vec3> &);
+    template <Interpolation, int> Solver & multiplyHessian(
+        const AlignedArray<glm::vec3> &, AlignedArray<glm::vec3> &);
+    template <Interpolation, int> glm::dvec2 computeObjective();
+    Solver & precondition();
+    template <Interpolation, int> size_t solveKrylov();
+    template <int> Solver & prepareImplicit();
+    Solver & project(AlignedArray<glm::vec3> &);
+    template <Interpolation, int> Solver & solveImplicit();
+    template <Interpolation, int> Solver & gridToParticle();
+    template <Interpolation, int> Solver & advance();
+    template <int> Solver & dispatch();
+
+public:
+    Solver();
+    Solver(float, float);
+    ~Solver();
+
+    bool addParticles(const ParticleSystem &);
+    Solver & clearParticles();
+    Solver & addCollider(const Collider &);
+    Solver & clearColliders();
+
+    Solver & step();
+    float advance(float);
+
+    float computeTimeStep() const;
+
+    Solver & setGridSpacing(float);
+    Solver & setTimeStep(float);
+    Solver & setGravity(const glm::vec3 &);
+    Solver & setBounds(const glm::vec3 &, const glm::vec3 &);
+    Solver & setThreadCount(size_t);
+    Solver & setSorting(bool);
+    Solver & setScatterStrategy(ScatterStrategy);
+    Solver & setInterpolation(Interpolation);
+    Solver & setDimension(int);
+    Solver & setConstitutiveModel(ConstitutiveModel);
+    Solver & setCflNumber(float);
+    Solver & setTimeStepBounds(float, float);
+    Solver & setMaximumSubsteps(size_t);
+    Solver & setIntegration(Integration);
+    Solver & setNewtonIterations(size_t);
+    Solver & setKrylovIterations(size_t);
+    Solver & setNewtonTolerance(float);
+    Solver & setKrylovTolerance(float);
+    Solver & setPreconditioner(Preconditioner);
+
+    float getGridSpacing() const;
+    float getTimeStep() const;
+    const glm::vec3 & getGravity() const;
+    const glm::vec3 & getMinimumBound() const;
+    const glm::vec3 & getMaximumBound() const;
+    size_t getThreadCount() const;
+    bool getSorting() const;
+    ScatterStrategy getScatterStrategy() const;
+    Interpolation getInterpolation() const;
+    int getDimension() const;
+    ConstitutiveModel getConstitutiveModel() const;
+    float getCflNumber() const;
+    float getMinimumTimeStep() const;
+    float getMaximumTimeStep() const;
+    size_t getMaximumSubsteps() const;
+    size_t getSubstepCount() const;
+    float getMaximumSpeed() const;
+    float getMaximumWaveSpeed() const;
+    Integration getIntegration() const;
+    size_t getNewtonIterations() const;
+    size_t getKrylovIterations() const;
+    float getNewtonTolerance() const;
+    float getKrylovTolerance() const;
+    Preconditioner getPreconditioner() const;
+    size_t getNewtonIterationCount() const;
+    size_t getKrylovIterationCount() const;
+
+    ParticleSystem & getParticles();
+    const ParticleSystem & getParticles() const;
+    const Grid & getGrid() const;
+    Collider & getCollider(size_t);
+    const std::vector<Collider> & getColliders() const;
+    size_t getColliderCount() const;
+    size_t getParticleCount() const;
+};
+
+MPM_NAMESPACE_END
+
+#endif
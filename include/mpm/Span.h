@@ -0,0 +1,78 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef MPM_SPAN_H
+#define MPM_SPAN_H
+
+#include <mpm/Global.h>
+
+#include <cstddef>
+
+MPM_NAMESPACE_BEGIN
+
+template <typename T>
+class Span {
+private:
+    T * pointer;
+    size_t count;
+
+public:
+    Span() : pointer(nullptr), count(0) {}
+    Span(T * pointer, size_t count) : pointer(pointer), count(count) {}
+
+    template <typename U>
+    Span(const Span<U> & span) : pointer(span.data()), count(span.size()) {}
+
+    T * data() const {
+        return pointer;
+    }
+    size_t size() const {
+        return count;
+    }
+    bool empty() const {
+        return count == 0;
+    }
+
+    T * begin() const {
+        return pointer;
+    }
+    T * end() const {
+        return pointer + count;
+    }
+
+    T & operator[](size_t i) const {
+        return pointer[i];
+    }
+
+    Span subspan(size_t offset, size_t count) const {
+        return Span(pointer + offset, count);
+    }
+};
+
+MPM_NAMESPACE_END
+
+#endif
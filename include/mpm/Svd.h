@@ -0,0 +1,427 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef MPM_SVD_H
+#define MPM_SVD_H
+
+#include <mpm/Global.h>
+#include <mpm/Constitutive.h>
+
+MPM_NAMESPACE_BEGIN
+
+static const int JACOBI_SWEEPS = 6;
+
+template <typename Lane>
+inline void conditionalSwap(const typename Lane::Mask & condition, Lane & x, Lane & y) {
+    Lane z = x;
+
+    x = Lane::select(condition, y, x);
+    y = Lane::select(condition, z, y);
+}
+template <typename Lane>
+inline void conditionalNegativeSwap(const typename Lane::Mask & condition, Lane & x, Lane & y) {
+    Lane z = -x;
+
+    x = Lane::select(condition, y, x);
+    y = Lane::select(condition, z, y);
+}
+
+template <typename Lane>
+inline Lane computeLog(const Lane & x) {
+    Lane exponent;
+    Lane mantissa = Lane::frexp(x, exponent);
+
+    typename Lane::Mask small = mantissa < Lane(0.707106781f);
+
+    exponent = Lane::select(small, exponent - Lane(1.0f), exponent);
+    mantissa = Lane::select(small, mantissa + mantissa, mantissa) - Lane(1.0f);
+
+    Lane square = mantissa * mantissa;
+    Lane y = Lane(7.0376836292e-2f);
+
+    y = y * mantissa + Lane(-1.1514610310e-1f);
+    y = y * mantissa + Lane(1.1676998740e-1f);
+    y = y * mantissa + Lane(-1.2420140846e-1f);
+    y = y * mantissa + Lane(1.4249322787e-1f);
+    y = y * mantissa + Lane(-1.6668057665e-1f);
+    y = y * mantissa + Lane(2.0000714765e-1f);
+    y = y * mantissa + Lane(-2.4999993993e-1f);
+    y = y * mantissa + Lane(3.3333331174e-1f);
+    y = y * mantissa * square;
+
+    y = y + Lane(-2.12194440e-4f) * exponent - Lane(0.5f) * square;
+
+    return mantissa + y + Lane(0.693359375f) * exponent;
+}
+
+template <typename Lane>
+inline Lane computeExp(const Lane & x) {
+    Lane clamped = Lane::min(Lane::max(x, Lane(-87.0f)), Lane(88.0f));
+    Lane exponent = Lane::floor(clamped * Lane(1.44269504f) + Lane(0.5f));
+    Lane remainder = clamped - exponent * Lane(0.693359375f) - exponent * Lane(-2.12194440e-4f);
+
+    Lane square = remainder * remainder;
+    Lane y = Lane(1.9875691500e-4f);
+
+    y = y * remainder + Lane(1.3981999507e-3f);
+    y = y * remainder + Lane(8.3334519073e-3f);
+    y = y * remainder + Lane(4.1665795894e-2f);
+    y = y * remainder + Lane(1.6666665459e-1f);
+    y = y * remainder + Lane(5.0000001201e-1f);
+    y = y * square + remainder + Lane(1.0f);
+
+    return Lane::ldexp(y, exponent);
+}
+
+template <typename Lane>
+inline void computeJacobiQuaternion(
+    const Lane & a11, const Lane & a21, const Lane & a22, Lane & ch, Lane & sh) {
+    ch = Lane(2.0f) * (a11 - a22);
+    sh = a21;
+
+    typename Lane::Mask accurate = Lane(5.828427125f) * sh * sh < ch * ch;
+    Lane w = Lane::rsqrt(ch * ch + sh * sh);
+
+    ch = Lane::select(accurate, w * ch, Lane(0.923879533f));
+    sh = Lane::select(accurate, w * sh, Lane(0.382683432f));
+}
+template <typename Lane>
+inline void conjugateJacobi(int x, int y, int z, Lane s[6], Lane q[4]) {
+    Lane ch, sh;
+    computeJacobiQuaternion(s[0], s[1], s[2], ch, sh);
+
+    Lane a = ch * ch - sh * sh;
+    Lane b = Lane(2.0f) * sh * ch;
+
+    Lane s11 = a * (a * s[0] + b * s[1]) + b * (a * s[1] + b * s[2]);
+    Lane s21 = a * (a * s[1] - b * s[0]) + b * (a * s[2] - b * s[1]);
+    Lane s22 = a * (a * s[2] - b * s[1]) - b * (a * s[1] - b * s[0]);
+    Lane s31 = a * s[3] + b * s[4];
+    Lane s32 = a * s[4] - b * s[3];
+    Lane s33 = s[5];
+
+    Lane t[3] = { q[0] * sh, q[1] * sh, q[2] * sh };
+
+    sh = sh * q[3];
+
+    for (int i = 0; i < 4; i++)
+        q[i] = q[i] * ch;
+
+    q[z] = q[z] + sh;
+    q[3] = q[3] - t[z];
+    q[x] = q[x] + t[y];
+    q[y] = q[y] - t[x];
+
+    s[0] = s22;
+    s[1] = s32;
+    s[2] = s33;
+    s[3] = s21;
+    s[4] = s31;
+    s[5] = s11;
+}
+
+template <typename Lane>
+inline void computeQrQuaternion(const Lane & a1, const Lane & a2, Lane & ch, Lane & sh) {
+    Lane rho = Lane::sqrt(a1 * a1 + a2 * a2);
+
+    sh = Lane::select(Lane(MPM_EPS) < rho, a2, Lane(0.0f));
+    ch = Lane::abs(a1) + Lane::max(rho, Lane(MPM_EPS));
+
+    conditionalSwap(a1 < Lane(0.0f), sh, ch);
+
+    Lane w = Lane::rsqrt(ch * ch + sh * sh);
+
+    ch = ch * w;
+    sh = sh * w;
+}
+template <typename Lane>
+inline void computeQr(Lane b[3][3], Lane q[3][3], Lane r[3][3]) {
+    Lane ch1, sh1, ch2, sh2, ch3, sh3;
+
+    computeQrQuaternion(b[0][0], b[1][0], ch1, sh1);
+
+    Lane a = Lane(1.0f) - Lane(2.0f) * sh1 * sh1;
+    Lane c = Lane(2.0f) * ch1 * sh1;
+
+    for (int j = 0; j < 3; j++) {
+        r[0][j] = a * b[0][j] + c * b[1][j];
+        r[1][j] = a * b[1][j] - c * b[0][j];
+        r[2][j] = b[2][j];
+    }
+
+    computeQrQuaternion(r[0][0], r[2][0], ch2, sh2);
+
+    a = Lane(1.0f) - Lane(2.0f) * sh2 * sh2;
+    c = Lane(2.0f) * ch2 * sh2;
+
+    for (int j = 0; j < 3; j++) {
+        b[0][j] = a * r[0][j] + c * r[2][j];
+        b[1][j] = r[1][j];
+        b[2][j] = a * r[2][j] - c * r[0][j];
+    }
+
+    computeQrQuaternion(b[1][1], b[2][1], ch3, sh3);
+
+    a = Lane(1.0f) - Lane(2.0f) * sh3 * sh3;
+    c = Lane(2.0f) * ch3 * sh3;
+
+    for (int j = 0; j < 3; j++) {
+        r[0][j] = b[0][j];
+        r[1][j] = a * b[1][j] + c * b[2][j];
+        r[2][j] = a * b[2][j] - c * b[1][j];
+    }
+
+    Lane one(1.0f), two(2.0f), four(4.0f);
+
+    Lane sh12 = two * sh1 * sh1 - one;
+    Lane sh22 = two * sh2 * sh2 - one;
+    Lane sh32 = two * sh3 * sh3 - one;
+
+    q[0][0] = sh12 * sh22;
+    q[0][1] = four * ch2 * ch3 * sh12 * sh2 * sh3 + two * ch1 * sh1 * sh32;
+    q[0][2] = four * ch1 * ch3 * sh1 * sh3 - two * ch2 * sh12 * sh2 * sh32;
+    q[1][0] = -two * ch1 * sh1 * sh22;
+    q[1][1] = Lane(-8.0f) * ch1 * ch2 * ch3 * sh1 * sh2 * sh3 + sh12 * sh32;
+    q[1][2] = four * sh1 * (ch3 * sh1 * sh3 + ch1 * ch2 * sh2 * sh32) - two * ch3 * sh3;
+    q[2][0] = two * ch2 * sh2;
+    q[2][1] = -two * ch3 * sh22 * sh3;
+    q[2][2] = sh22 * sh32;
+}
+
+template <typename Lane>
+inline void computeSvd(const Lane a[3][3], Lane u[3][3], Lane sigma[3], Lane v[3][3]) {
+    Lane s[6];
+
+    s[0] = a[0][0] * a[0][0] + a[1][0] * a[1][0] + a[2][0] * a[2][0];
+    s[1] = a[0][0] * a[0][1] + a[1][0] * a[1][1] + a[2][0] * a[2][1];
+    s[2] = a[0][1] * a[0][1] + a[1][1] * a[1][1] + a[2][1] * a[2][1];
+    s[3] = a[0][0] * a[0][2] + a[1][0] * a[1][2] + a[2][0] * a[2][2];
+    s[4] = a[0][1] * a[0][2] + a[1][1] * a[1][2] + a[2][1] * a[2][2];
+    s[5] = a[0][2] * a[0][2] + a[1][2] * a[1][2] + a[2][2] * a[2][2];
+
+    Lane q[4] = { Lane(0.0f), Lane(0.0f), Lane(0.0f), Lane(1.0f) };
+
+    for (int i = 0; i < JACOBI_SWEEPS; i++) {
+        conjugateJacobi(0, 1, 2, s, q);
+        conjugateJacobi(1, 2, 0, s, q);
+        conjugateJacobi(2, 0, 1, s, q);
+    }
+
+    Lane norm = Lane::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+
+    for (int i = 0; i < 4; i++)
+        q[i] = q[i] / norm;
+
+    Lane one(1.0f), two(2.0f);
+
+    v[0][0] = one - two * (q[1] * q[1] + q[2] * q[2]);
+    v[0][1] = two * (q[0] * q[1] - q[3] * q[2]);
+    v[0][2] = two * (q[0] * q[2] + q[3] * q[1]);
+    v[1][0] = two * (q[0] * q[1] + q[3] * q[2]);
+    v[1][1] = one - two * (q[0] * q[0] + q[2] * q[2]);
+    v[1][2] = two * (q[1] * q[2] - q[3] * q[0]);
+    v[2][0] = two * (q[0] * q[2] - q[3] * q[1]);
+    v[2][1] = two * (q[1] * q[2] + q[3] * q[0]);
+    v[2][2] = one - two * (q[0] * q[0] + q[1] * q[1]);
+
+    Lane b[3][3];
+
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++)
+            b[i][j] = a[i][0] * v[0][j] + a[i][1] * v[1][j] + a[i][2] * v[2][j];
+    }
+
+    Lane rho[3];
+
+    for (int j = 0; j < 3; j++)
+        rho[j] = b[0][j] * b[0][j] + b[1][j] * b[1][j] + b[2][j] * b[2][j];
+
+    const int pairs[3][2] = { { 0, 1 }, { 0, 2 }, { 1, 2 } };
+
+    for (int k = 0; k < 3; k++) {
+        int i = pairs[k][0];
+        int j = pairs[k][1];
+
+        typename Lane::Mask condition = rho[i] < rho[j];
+
+        for (int row = 0; row < 3; row++) {
+            conditionalNegativeSwap(condition, b[row][i], b[row][j]);
+            conditionalNegativeSwap(condition, v[row][i], v[row][j]);
+        }
+
+        conditionalSwap(condition, rho[i], rho[j]);
+    }
+
+    Lane r[3][3];
+    computeQr(b, u, r);
+
+    for (int i = 0; i < 3; i++)
+        sigma[i] = r[i][i];
+}
+
+template <typename Lane>
+inline void loadMatrix(const float (&source)[9][KERNEL_BATCH_SIZE], size_t p, Lane matrix[3][3]) {
+    for (int column = 0; column < 3; column++) {
+        for (int row = 0; row < 3; row++)
+            matrix[row][column] = Lane::load(&source[3 * column + row][p]);
+    }
+}
+template <typename Lane>
+inline void storeMatrix(const Lane matrix[3][3], size_t p, float (&target)[9][KERNEL_BATCH_SIZE]) {
+    for (int column = 0; column < 3; column++) {
+        for (int row = 0; row < 3; row++)
+            Lane::store(&target[3 * column + row][p], matrix[row][column]);
+    }
+}
+
+template <typename Lane>
+inline void computeSvdBatch(SvdBatch & batch, size_t count) {
+    for (size_t p = 0; p < count; p += Lane::WIDTH) {
+        Lane a[3][3], u[3][3], sigma[3], v[3][3];
+
+        loadMatrix(batch.matrices, p, a);
+        computeSvd(a, u, sigma, v);
+
+        storeMatrix(u, p, batch.u);
+        storeMatrix(v, p, batch.v);
+
+        for (int i = 0; i < 3; i++)
+            Lane::store(&batch.sigma[i][p], sigma[i]);
+    }
+}
+
+template <typename Lane>
+inline void computeNeoHookeanStress(
+    const Lane f[3][3], const Lane & lambda, const Lane & mu, Lane stress[3][3]) {
+    Lane determinant =
+        f[0][0] * (f[1][1] * f[2][2] - f[1][2] * f[2][1]) -
+        f[0][1] * (f[1][0] * f[2][2] - f[1][2] * f[2][0]) +
+        f[0][2] * (f[1][0] * f[2][1] - f[1][1] * f[2][0]);
+
+    Lane pressure = lambda * computeLog(Lane::max(determinant, Lane(MPM_EPS)));
+
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            Lane product = f[i][0] * f[j][0] + f[i][1] * f[j][1] + f[i][2] * f[j][2];
+            stress[i][j] = mu * product;
+        }
+
+        stress[i][i] = stress[i][i] - mu + pressure;
+    }
+}
+template <typename Lane>
+inline void computeFixedCorotatedStress(
+    const Lane f[3][3], const Lane & lambda, const Lane & mu, Lane stress[3][3]) {
+    Lane u[3][3], sigma[3], v[3][3];
+    computeSvd(f, u, sigma, v);
+
+    Lane determinant = sigma[0] * sigma[1] * sigma[2];
+    Lane pressure = lambda * (determinant - Lane(1.0f)) * determinant;
+    Lane difference[3][3];
+
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            Lane rotation = u[i][0] * v[j][0] + u[i][1] * v[j][1] + u[i][2] * v[j][2];
+            difference[i][j] = Lane(2.0f) * mu * (f[i][j] - rotation);
+        }
+    }
+
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            stress[i][j] = difference[i][0] * f[j][0]
+                + difference[i][1] * f[j][1] + difference[i][2] * f[j][2];
+        }
+
+        stress[i][i] = stress[i][i] + pressure;
+    }
+}
+
+template <typename Lane>
+inline void computeReturnMapping(Lane f[3][3], const Lane & yieldStrain, const Lane & relaxation) {
+    Lane u[3][3], sigma[3], v[3][3];
+    computeSvd(f, u, sigma, v);
+
+    Lane strain[3];
+
+    for (int i = 0; i < 3; i++)
+        strain[i] = computeLog(Lane::max(Lane::abs(sigma[i]), Lane(MPM_EPS)));
+
+    Lane mean = (strain[0] + strain[1] + strain[2]) * Lane(1.0f / 3.0f);
+    Lane deviator[3] = { strain[0] - mean, strain[1] - mean, strain[2] - mean };
+
+    Lane norm = Lane::sqrt(
+        deviator[0] * deviator[0] + deviator[1] * deviator[1] + deviator[2] * deviator[2]);
+    Lane excess = Lane::max(norm - yieldStrain, Lane(0.0f));
+    Lane scale = Lane(1.0f) - relaxation * excess / Lane::max(norm, Lane(MPM_EPS));
+
+    for (int i = 0; i < 3; i++) {
+        Lane stretch = computeExp(mean + scale * deviator[i]);
+        sigma[i] = Lane::select(sigma[i] < Lane(0.0f), -stretch, stretch);
+    }
+
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            f[i][j] = u[i][0] * sigma[0] * v[j][0]
+                + u[i][1] * sigma[1] * v[j][1] + u[i][2] * sigma[2] * v[j][2];
+        }
+    }
+}
+
+template <typename Lane>
+inline void computeReturnMappingBatch(PlasticityBatch & batch, size_t count) {
+    for (size_t p = 0; p < count; p += Lane::WIDTH) {
+        Lane f[3][3];
+        loadMatrix(batch.deformationGradients, p, f);
+
+        computeReturnMapping(f,
+            Lane::load(&batch.yieldStrains[p]), Lane::load(&batch.relaxations[p]));
+
+        storeMatrix(f, p, batch.deformationGradients);
+    }
+}
+
+template <typename Lane>
+inline void computeStressBatch(ConstitutiveModel model, StressBatch & batch, size_t count) {
+    for (size_t p = 0; p < count; p += Lane::WIDTH) {
+        Lane f[3][3], stress[3][3];
+        loadMatrix(batch.deformationGradients, p, f);
+
+        Lane lambda = Lane::load(&batch.lambdas[p]);
+        Lane mu = Lane::load(&batch.mus[p]);
+
+        if (model == ConstitutiveModel::FixedCorotated)
+            computeFixedCorotatedStress(f, lambda, mu, stress);
+        else
+            computeNeoHookeanStress(f, lambda, mu, stress);
+
+        storeMatrix(stress, p, batch.stresses);
+    }
+}
+
+MPM_NAMESPACE_END
+
+#endif
@@ -0,0 +1,108 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef MPM_TRIANGLE_BVH_H
+#define MPM_TRIANGLE_BVH_H
+
+#include <mpm/Global.h>
+#include <mpm/TriangleMesh.h>
+#include <mpm/CompactTriangleMesh.h>
+#include <mpm/Span.h>
+
+#include <glm/vec3.hpp>
+
+#include <vector>
+#include <cstdint>
+
+MPM_NAMESPACE_BEGIN
+
+class TriangleBvh {
+public:
+    class Node {
+    public:
+        glm::vec3 lower;
+        uint32_t right;
+        glm::vec3 upper;
+        uint32_t triangle;
+    };
+
+    class Triangle {
+    public:
+        glm::vec3 a;
+        glm::vec3 b;
+        glm::vec3 c;
+        uint32_t index;
+    };
+
+private:
+    std::vector<Node> nodes;
+    std::vector<Triangle> triangles;
+    std::vector<uint32_t> parents;
+    std::vector<uint32_t> leaves;
+    std::vector<uint8_t> marks;
+
+    void build(size_t, size_t, size_t, const std::vector<uint32_t> &);
+    void refit(size_t);
+
+    template <typename T> TriangleBvh & createFrom(const T &);
+    template <typename T> TriangleBvh & refitFrom(const T &);
+    template <typename T> TriangleBvh & refitFrom(const T &, const std::vector<uint32_t> &);
+
+public:
+    TriangleBvh();
+    TriangleBvh(const TriangleMesh &);
+    TriangleBvh(const CompactTriangleMesh &);
+    ~TriangleBvh();
+
+    TriangleBvh & create(const TriangleMesh &);
+    TriangleBvh & create(const CompactTriangleMesh &);
+    TriangleBvh & refit(const TriangleMesh &);
+    TriangleBvh & refit(const CompactTriangleMesh &);
+    TriangleBvh & refit(const TriangleMesh &, const std::vector<uint32_t> &);
+    TriangleBvh & refit(const CompactTriangleMesh &, const std::vector<uint32_t> &);
+    TriangleBvh & clear();
+
+    float getClosestPoint(const glm::vec3 &, glm::vec3 &, size_t &) const;
+    size_t countIntersections(const glm::vec3 &, const glm::vec3 &) const;
+    void getIntersections(const glm::vec3 &, const glm::vec3 &, std::vector<float> &) const;
+    bool isInside(const glm::vec3 &) const;
+    float getSignedDistance(const glm::vec3 &) const;
+
+    void getClosestPoints(Span<const glm::vec3>, Span<glm::vec3>, Span<float>) const;
+    void getSignedDistances(Span<const glm::vec3>, Span<float>) const;
+    void classifyPoints(Span<const glm::vec3>, Span<uint8_t>) const;
+
+    const std::vector<Node> & getNodes() const;
+    const std::vector<Triangle> & getTriangles() const;
+    void getBounds(glm::vec3 &, glm::vec3 &) const;
+    size_t getTriangleCount() const;
+    bool empty() const;
+};
+
+MPM_NAMESPACE_END
+
+#endif
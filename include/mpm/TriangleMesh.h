@@ -32,9 +32,11 @@
 
 #include <vector>
 #include <string>
+#include <cstdint>
 
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
+#include <glm/mat3x3.hpp>
 #include <glm/mat4x4.hpp>
 
 MPM_NAMESPACE_BEGIN
@@ -47,9 +49,16 @@ private:
     std::vector<size_t> vertexIndices;
     std::vector<size_t> normalIndices;
     std::vector<size_t> textureIndices;
+    glm::mat4 transformation;
+    glm::mat3 normalTransformation;
+
+    static TriangleMesh * loadObj(const char *, size_t);
+    static TriangleMesh * loadBinary(const char *, size_t);
+
+    bool writeMesh(const std::string &, uint64_t, int64_t) const;
 
 public:
-    static TriangleMesh * loadMesh(const std::string &);
+    static TriangleMesh * loadMesh(const std::string &, const std::string & = std::string());
 
     TriangleMesh();
     TriangleMesh(const TriangleMesh &);
@@ -102,6 +111,13 @@ public:
     bool hasNormals() const;
     bool hasTextureCoordinates() const;
 
+    TriangleMesh & setTransformation(const glm::mat4 &);
+    const glm::mat4 & getTransformation() const;
+    const glm::mat3 & getNormalTransformation() const;
+    glm::vec3 getTransformedVertex(size_t) const;
+    glm::vec3 getTransformedNormal(size_t) const;
+    bool hasTransformation() const;
+
     TriangleMesh & create(const TriangleMesh &);
     TriangleMesh & create(size_t, size_t, size_t = 0, size_t = 0);
     TriangleMesh & create(
@@ -120,7 +136,10 @@ public:
         const std::vector<size_t> &,
         const std::vector<size_t> &);
 
-    TriangleMesh & transform(const glm::mat4 &);
+    TriangleMesh & transform(const glm::mat4 &, bool = false);
+    TriangleMesh & applyTransformation();
+
+    bool saveMesh(const std::string &) const;
 };
 
 MPM_NAMESPACE_END
@@ -30,6 +30,7 @@
 
 #include <mpm/Global.h>
 #include <mpm/Camera.h>
+#include <mpm/Solver.h>
 
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
@@ -57,9 +58,11 @@ private:
     size_t width;
     size_t height;
     bool grid;
+    bool simulation;
 
     GLFWwindow * window;
     Camera camera;
+    Solver solver;
 
     Viewer & initialize();
     Viewer & render();
@@ -93,11 +96,13 @@ public:
     Viewer & setHeight(size_t);
     Viewer & setWidth(size_t);
     Viewer & setGrid(bool);
+    Viewer & setSimulation(bool);
 
     const std::string & getTitle() const;
     size_t getHeight() const;
     size_t getWidth() const;
     bool getGrid() const;
+    bool getSimulation() const;
 
     Viewer & show();
     Viewer & close();
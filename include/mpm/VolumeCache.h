@@ -0,0 +1,67 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef MPM_VOLUME_CACHE_H
+#define MPM_VOLUME_CACHE_H
+
+#include <mpm/Global.h>
+#include <mpm/TriangleMesh.h>
+
+#include <glm/vec3.hpp>
+
+#include <openvdb/openvdb.h>
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+MPM_NAMESPACE_BEGIN
+
+class VolumeCache {
+private:
+    std::string directory;
+
+    std::string getPath(uint64_t, const std::string &) const;
+
+public:
+    static uint64_t computeHash(const void *, size_t, uint64_t = 0xcbf29ce484222325);
+    static uint64_t computeHash(const TriangleMesh &, uint64_t = 0xcbf29ce484222325);
+
+    VolumeCache(const std::string &);
+    ~VolumeCache();
+
+    openvdb::FloatGrid::Ptr loadVolume(uint64_t) const;
+    bool saveVolume(uint64_t, openvdb::FloatGrid::ConstPtr) const;
+    bool loadPoints(uint64_t, std::vector<glm::vec3> &, float &) const;
+    bool savePoints(uint64_t, const std::vector<glm::vec3> &, float) const;
+
+    const std::string & getDirectory() const;
+};
+
+MPM_NAMESPACE_END
+
+#endif
@@ -0,0 +1,471 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <mpm/Collider.h>
+#include <mpm/MeshToParticle.h>
+
+#include <openvdb/tools/MeshToVolume.h>
+#include <openvdb/tools/Interpolation.h>
+#include <openvdb/math/Operators.h>
+#include <openvdb/tools/Prune.h>
+
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+MPM_NAMESPACE_BEGIN
+
+static const float COLLIDER_BAND_WIDTH = 3.0f;
+static const uint32_t COLLIDER_TAG = 0x4c4c4f43;
+
+static bool compareCoordinates(const openvdb::Coord & a, const openvdb::Coord & b) {
+    if (a.x() != b.x())
+        return a.x() < b.x();
+
+    if (a.y() != b.y())
+        return a.y() < b.y();
+
+    return a.z() < b.z();
+}
+static void addLeaves(const glm::vec3 & lower, const glm::vec3 & upper,
+    float voxelSize, std::vector<openvdb::Coord> & leaves) {
+    const int dimension = openvdb::FloatTree::LeafNodeType::DIM;
+
+    openvdb::Coord minimum, maximum;
+
+    for (int axis = 0; axis < 3; axis++) {
+        minimum[axis] = (int)std::floor(lower[axis] / voxelSize) & ~(dimension - 1);
+        maximum[axis] = (int)std::ceil(upper[axis] / voxelSize) & ~(dimension - 1);
+    }
+
+    for (int x = minimum.x(); x <= maximum.x(); x += dimension) {
+        for (int y = minimum.y(); y <= maximum.y(); y += dimension) {
+            for (int z = minimum.z(); z <= maximum.z(); z += dimension)
+                leaves.push_back(openvdb::Coord(x, y, z));
+        }
+    }
+}
+static void voxelizeLeaf(openvdb::FloatTree::LeafNodeType & leaf, const TriangleBvh & bvh,
+    float voxelSize, float background) {
+    const int dimension = openvdb::FloatTree::LeafNodeType::DIM;
+    const openvdb::Coord & origin = leaf.origin();
+
+    for (int x = 0; x < dimension; x++) {
+        for (int y = 0; y < dimension; y++) {
+            for (int z = 0; z < dimension; z++) {
+                glm::vec3 position = voxelSize
+                    * glm::vec3(origin.x() + x, origin.y() + y, origin.z() + z);
+
+                glm::vec3 closest;
+                size_t triangle;
+                float distance = bvh.getClosestPoint(position, closest, triangle);
+
+                // The three ray vote keeps open or self-intersecting meshes
+                // signed the same way as the rest of the volume.
+                if (bvh.isInside(position))
+                    distance = -distance;
+
+                openvdb::Index offset = openvdb::FloatTree::LeafNodeType::coordToOffset(
+                    origin + openvdb::Coord(x, y, z));
+
+                if (std::abs(distance) < background)
+                    leaf.setValueOn(offset, distance);
+                else
+                    leaf.setValueOff(offset, distance < 0 ? -background : background);
+            }
+        }
+    }
+}
+
+Collider::Sampler::Sampler(const Collider & collider)
+    : collider(&collider), accessor(collider.volume->getConstAccessor()) {}
+
+bool Collider::Sampler::apply(const glm::vec3 & position, glm::vec3 & velocity) {
+    glm::vec3 local = position - collider->translation;
+
+    for (int axis = 0; axis < 3; axis++) {
+        if (local[axis] < collider->lower[axis] || local[axis] > collider->upper[axis])
+            return false;
+    }
+
+    openvdb::Vec3d index = collider->volume->worldToIndex(openvdb::Vec3d(local.x, local.y, local.z));
+
+    if (openvdb::tools::BoxSampler::sample(accessor, index) > 0.0f)
+        return false;
+
+    if (collider->contact == Contact::Sticky) {
+        velocity = collider->velocity;
+        return true;
+    }
+
+    openvdb::Vec3s gradient = openvdb::math::ISGradient<openvdb::math::CD_2ND>::result(
+        accessor, openvdb::Coord::round(index));
+    glm::vec3 normal(gradient.x(), gradient.y(), gradient.z());
+    float length = glm::length(normal);
+
+    // Past the interior band the level set is flat, so deep nodes take their
+    // normal from the closest surface point. Raw volumes have no surface to
+    // query and leave such nodes alone rather than changing the contact.
+    if (length <= 0.0f && !collider->bvh.empty()) {
+        glm::vec3 closest;
+        size_t triangle;
+        collider->bvh.getClosestPoint(local, closest, triangle);
+
+        normal = closest - local;
+        length = glm::length(normal);
+    }
+
+    if (length <= 0.0f)
+        return false;
+
+    normal /= length;
+
+    glm::vec3 relative = velocity - collider->velocity;
+    float normalSpeed = glm::dot(relative, normal);
+
+    if (collider->contact == Contact::Separate && normalSpeed >= 0.0f)
+        return false;
+
+    glm::vec3 tangent = relative - normalSpeed * normal;
+    float tangentSpeed = glm::length(tangent);
+
+    if (collider->friction > 0.0f && normalSpeed < 0.0f && tangentSpeed > 0.0f)
+        tangent *= std::max(1.0f + collider->friction * normalSpeed / tangentSpeed, 0.0f);
+
+    velocity = tangent + collider->velocity;
+
+    return true;
+}
+
+Collider::Collider() {
+    lower = glm::vec3(0);
+    upper = glm::vec3(0);
+    translation = glm::vec3(0);
+    velocity = glm::vec3(0);
+    contact = Contact::Slip;
+    friction = 0;
+    voxelSize = 0;
+}
+Collider::Collider(const TriangleMesh * mesh, float voxelSize,
+    Contact contact, const VolumeCache * cache) : Collider() {
+    this->contact = contact;
+    create(mesh, voxelSize, cache);
+}
+Collider::Collider(openvdb::FloatGrid::ConstPtr volume, Contact contact) : Collider() {
+    this->contact = contact;
+    setVolume(volume);
+}
+Collider::Collider(const Collider & collider) {
+    *this = collider;
+}
+Collider::~Collider() {}
+
+Collider & Collider::operator=(const Collider & collider) {
+    if (this == &collider)
+        return *this;
+
+    // A mesh volume is rebuilt in place by update(), so every copy owns its
+    // grid; bounds and BVH then always describe the grid being sampled.
+    if (collider.meshVolume) {
+        meshVolume = collider.meshVolume->deepCopy();
+        volume = meshVolume;
+    } else {
+        meshVolume.reset();
+        volume = collider.volume;
+    }
+
+    references = collider.references;
+    adjacencyOffsets = collider.adjacencyOffsets;
+    adjacentTriangles = collider.adjacentTriangles;
+    bvh = collider.bvh;
+    voxelSize = collider.voxelSize;
+    lower = collider.lower;
+    upper = collider.upper;
+    translation = collider.translation;
+    velocity = collider.velocity;
+    contact = collider.contact;
+    friction = collider.friction;
+
+    return *this;
+}
+
+Collider & Collider::computeBounds() {
+    lower = glm::vec3(0);
+    upper = glm::vec3(0);
+
+    if (empty())
+        return *this;
+
+    openvdb::CoordBBox bounds = volume->evalActiveVoxelBoundingBox();
+    openvdb::Vec3d minimum = volume->indexToWorld(bounds.min());
+    openvdb::Vec3d maximum = volume->indexToWorld(bounds.max());
+
+    lower = glm::vec3(minimum.x(), minimum.y(), minimum.z());
+    upper = glm::vec3(maximum.x(), maximum.y(), maximum.z());
+
+    return *this;
+}
+
+Collider & Collider::create(const TriangleMesh * mesh, float voxelSize, const VolumeCache * cache) {
+    uint64_t key = 0;
+
+    if (cache) {
+        key = VolumeCache::computeHash(*mesh);
+        key = VolumeCache::computeHash(&voxelSize, sizeof(voxelSize), key);
+        key = VolumeCache::computeHash(&COLLIDER_TAG, sizeof(COLLIDER_TAG), key);
+
+        openvdb::FloatGrid::Ptr cached = cache->loadVolume(key);
+
+        if (cached)
+            return setVolume(cached).track(mesh, voxelSize, cached);
+    }
+
+    MeshDataAdapter meshDataAdapter(mesh, voxelSize);
+
+    openvdb::FloatGrid::Ptr grid = openvdb::tools::meshToVolume<openvdb::FloatGrid>(
+        meshDataAdapter, meshDataAdapter.getTransform(), COLLIDER_BAND_WIDTH, COLLIDER_BAND_WIDTH);
+
+    if (cache)
+        cache->saveVolume(key, grid);
+
+    return setVolume(grid).track(mesh, voxelSize, grid);
+}
+Collider & Collider::update(const TriangleMesh * mesh, float tolerance) {
+    size_t vertexCount = mesh->getVertexCount();
+    size_t triangleCount = mesh->getTriangleCount();
+
+    if (!meshVolume || references.size() != vertexCount || bvh.getTriangleCount() != triangleCount) {
+        if (voxelSize <= 0 && volume)
+            voxelSize = (float)volume->voxelSize()[0];
+
+        return voxelSize > 0 ? create(mesh, voxelSize) : *this;
+    }
+
+    float toleranceSquared = tolerance * tolerance;
+    tbb::enumerable_thread_specific<std::vector<uint32_t>> localMoved;
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, vertexCount),
+        [&](const tbb::blocked_range<size_t> & range) {
+        std::vector<uint32_t> & moved = localMoved.local();
+
+        for (size_t i = range.begin(); i < range.end(); i++) {
+            glm::vec3 offset = mesh->getTransformedVertex(i) - references[i];
+
+            if (glm::dot(offset, offset) > toleranceSquared)
+                moved.push_back((uint32_t)i);
+        }
+    });
+
+    std::vector<uint32_t> moved;
+    std::vector<uint32_t> dirty;
+
+    for (const std::vector<uint32_t> & local : localMoved)
+        moved.insert(moved.end(), local.begin(), local.end());
+
+    for (uint32_t vertex : moved) {
+        dirty.insert(dirty.end(), adjacentTriangles.begin() + adjacencyOffsets[vertex],
+            adjacentTriangles.begin() + adjacencyOffsets[vertex + 1]);
+    }
+
+    if (dirty.empty())
+        return *this;
+
+    std::sort(dirty.begin(), dirty.end());
+    dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+
+    float margin = meshVolume->background();
+    tbb::enumerable_thread_specific<std::vector<openvdb::Coord>> localLeaves;
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, dirty.size()),
+        [&](const tbb::blocked_range<size_t> & range) {
+        std::vector<openvdb::Coord> & leaves = localLeaves.local();
+
+        for (size_t i = range.begin(); i < range.end(); i++) {
+            size_t v[3];
+            mesh->getVertexIndices(dirty[i], v[0], v[1], v[2]);
+
+            glm::vec3 lower = references[v[0]];
+            glm::vec3 upper = references[v[0]];
+
+            for (int j = 0; j < 3; j++) {
+                glm::vec3 position = mesh->getTransformedVertex(v[j]);
+
+                lower = glm::min(lower, glm::min(references[v[j]], position));
+                upper = glm::max(upper, glm::max(references[v[j]], position));
+            }
+
+            addLeaves(lower - glm::vec3(margin), upper + glm::vec3(margin), voxelSize, leaves);
+        }
+    });
+
+    std::vector<openvdb::Coord> leaves;
+
+    for (const std::vector<openvdb::Coord> & local : localLeaves)
+        leaves.insert(leaves.end(), local.begin(), local.end());
+
+    std::sort(leaves.begin(), leaves.end(), compareCoordinates);
+    leaves.erase(std::unique(leaves.begin(), leaves.end()), leaves.end());
+
+    openvdb::FloatTree & tree = meshVolume->tree();
+
+    if (2 * leaves.size() > tree.leafCount())
+        return create(mesh, voxelSize);
+
+    for (uint32_t vertex : moved)
+        references[vertex] = mesh->getTransformedVertex(vertex);
+
+    bvh.refit(*mesh, dirty);
+
+    std::vector<openvdb::FloatTree::LeafNodeType *> nodes(leaves.size());
+
+    for (size_t i = 0; i < leaves.size(); i++)
+        nodes[i] = tree.touchLeaf(leaves[i]);
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, nodes.size()),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t i = range.begin(); i < range.end(); i++)
+            voxelizeLeaf(*nodes[i], bvh, voxelSize, margin);
+    });
+
+    openvdb::tools::pruneLevelSet(tree);
+
+    return computeBounds();
+}
+Collider & Collider::track(const TriangleMesh * mesh, float voxelSize, openvdb::FloatGrid::Ptr grid) {
+    size_t triangleCount = mesh->getTriangleCount();
+
+    this->voxelSize = voxelSize;
+    meshVolume = grid;
+    references.resize(mesh->getVertexCount());
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, references.size()),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t i = range.begin(); i < range.end(); i++)
+            references[i] = mesh->getTransformedVertex(i);
+    });
+
+    // Triangles around each vertex, so update() reaches the dirty triangles
+    // from the moved vertices alone.
+    adjacencyOffsets.assign(references.size() + 1, 0);
+
+    for (size_t i = 0; i < triangleCount; i++) {
+        size_t v[3];
+        mesh->getVertexIndices(i, v[0], v[1], v[2]);
+
+        for (int j = 0; j < 3; j++)
+            adjacencyOffsets[v[j] + 1]++;
+    }
+
+    for (size_t i = 0; i < references.size(); i++)
+        adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+
+    std::vector<uint32_t> cursors(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    adjacentTriangles.resize(adjacencyOffsets.back());
+
+    for (size_t i = 0; i < triangleCount; i++) {
+        size_t v[3];
+        mesh->getVertexIndices(i, v[0], v[1], v[2]);
+
+        for (int j = 0; j < 3; j++)
+            adjacentTriangles[cursors[v[j]]++] = (uint32_t)i;
+    }
+
+    bvh.create(*mesh);
+
+    return *this;
+}
+Collider & Collider::advance(float timeStep) {
+    translation += timeStep * velocity;
+    return *this;
+}
+
+Collider & Collider::setVolume(openvdb::FloatGrid::ConstPtr volume) {
+    this->volume = volume;
+
+    meshVolume.reset();
+    std::vector<glm::vec3>().swap(references);
+    std::vector<uint32_t>().swap(adjacencyOffsets);
+    std::vector<uint32_t>().swap(adjacentTriangles);
+    bvh.clear();
+
+    return computeBounds();
+}
+Collider & Collider::setTranslation(const glm::vec3 & translation) {
+    this->translation = translation;
+    return *this;
+}
+Collider & Collider::setVelocity(const glm::vec3 & velocity) {
+    this->velocity = velocity;
+    return *this;
+}
+Collider & Collider::setContact(Contact contact) {
+    this->contact = contact;
+    return *this;
+}
+Collider & Collider::setFriction(float friction) {
+    this->friction = friction;
+    return *this;
+}
+
+openvdb::FloatGrid::ConstPtr Collider::getVolume() const {
+    return volume;
+}
+const glm::vec3 & Collider::getTranslation() const {
+    return translation;
+}
+const glm::vec3 & Collider::getVelocity() const {
+    return velocity;
+}
+Contact Collider::getContact() const {
+    return contact;
+}
+float Collider::getFriction() const {
+    return friction;
+}
+bool Collider::overlaps(const glm::vec3 & lower, const glm::vec3 & upper) const {
+    if (empty())
+        return false;
+
+    for (int axis = 0; axis < 3; axis++) {
+        if (upper[axis] < this->lower[axis] + translation[axis]
+            || lower[axis] > this->upper[axis] + translation[axis])
+            return false;
+    }
+
+    return true;
+}
+bool Collider::empty() const {
+    return !volume;
+}
+
+MPM_NAMESPACE_END
@@ -0,0 +1,208 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <mpm/CompactTriangleMesh.h>
+
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+#include <tbb/blocked_range.h>
+
+#include <limits>
+
+MPM_NAMESPACE_BEGIN
+
+class Corner {
+public:
+    size_t vertex;
+    size_t normal;
+    size_t texture;
+    uint32_t index;
+
+    bool matches(const Corner & corner) const {
+        return vertex == corner.vertex && normal == corner.normal && texture == corner.texture;
+    }
+    bool operator<(const Corner & corner) const {
+        if (vertex != corner.vertex)
+            return vertex < corner.vertex;
+
+        if (normal != corner.normal)
+            return normal < corner.normal;
+
+        if (texture != corner.texture)
+            return texture < corner.texture;
+
+        return index < corner.index;
+    }
+};
+
+CompactTriangleMesh::CompactTriangleMesh() : withNormals(false), withTextureCoordinates(false) {}
+CompactTriangleMesh::CompactTriangleMesh(const TriangleMesh & mesh) {
+    create(mesh);
+}
+CompactTriangleMesh::~CompactTriangleMesh() {}
+
+CompactTriangleMesh & CompactTriangleMesh::create(const TriangleMesh & mesh) {
+    clear();
+
+    const std::vector<size_t> & vertexIndices = mesh.getVertexIndices();
+    const std::vector<size_t> & normalIndices = mesh.getNormalIndices();
+    const std::vector<size_t> & textureIndices = mesh.getTextureIndices();
+
+    size_t cornerCount = vertexIndices.size();
+
+    if (cornerCount >= std::numeric_limits<uint32_t>::max())
+        return *this;
+
+    withNormals = mesh.hasNormals() && normalIndices.size() == cornerCount;
+    withTextureCoordinates = mesh.hasTextureCoordinates() && textureIndices.size() == cornerCount;
+
+    std::vector<Corner> corners(cornerCount);
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, cornerCount),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t i = range.begin(); i < range.end(); i++) {
+            Corner & corner = corners[i];
+
+            corner.vertex = vertexIndices[i];
+            corner.normal = withNormals ? normalIndices[i] : 0;
+            corner.texture = withTextureCoordinates ? textureIndices[i] : 0;
+            corner.index = (uint32_t)i;
+        }
+    });
+
+    tbb::parallel_sort(corners.begin(), corners.end());
+
+    std::vector<uint32_t> representatives(cornerCount);
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, cornerCount),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t i = range.begin(); i < range.end(); i++) {
+            if (i > 0 && corners[i].matches(corners[i - 1]))
+                continue;
+
+            for (size_t j = i; j < cornerCount && corners[j].matches(corners[i]); j++)
+                representatives[corners[j].index] = corners[i].index;
+        }
+    });
+
+    std::vector<Corner>().swap(corners);
+
+    std::vector<uint32_t> identifiers(cornerCount);
+    uint32_t vertexCount = 0;
+
+    for (size_t i = 0; i < cornerCount; i++) {
+        if (representatives[i] == i)
+            identifiers[i] = vertexCount++;
+    }
+
+    vertices.resize(vertexCount);
+    indices.resize(cornerCount);
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, cornerCount),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t i = range.begin(); i < range.end(); i++) {
+            uint32_t identifier = identifiers[representatives[i]];
+            indices[i] = identifier;
+
+            if (representatives[i] != i)
+                continue;
+
+            Vertex & vertex = vertices[identifier];
+
+            vertex.position = mesh.getTransformedVertex(vertexIndices[i]);
+            vertex.normal = withNormals ? mesh.getTransformedNormal(normalIndices[i]) : glm::vec3(0);
+            vertex.textureCoordinates = withTextureCoordinates ?
+                mesh.getTextureCoordinates(textureIndices[i]) : glm::vec2(0);
+        }
+    });
+
+    return *this;
+}
+CompactTriangleMesh & CompactTriangleMesh::clear() {
+    std::vector<Vertex>().swap(vertices);
+    std::vector<uint32_t>().swap(indices);
+
+    withNormals = false;
+    withTextureCoordinates = false;
+
+    return *this;
+}
+TriangleMesh * CompactTriangleMesh::expand() const {
+    std::vector<glm::vec3> positions(vertices.size());
+    std::vector<glm::vec3> normals(withNormals ? vertices.size() : 0);
+    std::vector<glm::vec2> textureCoordinates(withTextureCoordinates ? vertices.size() : 0);
+    std::vector<size_t> vertexIndices(indices.begin(), indices.end());
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, vertices.size()),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t i = range.begin(); i < range.end(); i++) {
+            positions[i] = vertices[i].position;
+
+            if (withNormals)
+                normals[i] = vertices[i].normal;
+
+            if (withTextureCoordinates)
+                textureCoordinates[i] = vertices[i].textureCoordinates;
+        }
+    });
+
+    return new TriangleMesh(positions, normals, textureCoordinates, vertexIndices,
+        withNormals ? vertexIndices : std::vector<size_t>(),
+        withTextureCoordinates ? vertexIndices : std::vector<size_t>());
+}
+
+const std::vector<CompactTriangleMesh::Vertex> & CompactTriangleMesh::getVertices() const {
+    return vertices;
+}
+const std::vector<uint32_t> & CompactTriangleMesh::getIndices() const {
+    return indices;
+}
+const CompactTriangleMesh::Vertex & CompactTriangleMesh::getVertex(size_t i) const {
+    return vertices[i];
+}
+void CompactTriangleMesh::getIndices(size_t i, uint32_t & a, uint32_t & b, uint32_t & c) const {
+    a = indices[3 * i];
+    b = indices[3 * i + 1];
+    c = indices[3 * i + 2];
+}
+size_t CompactTriangleMesh::getVertexCount() const {
+    return vertices.size();
+}
+size_t CompactTriangleMesh::getTriangleCount() const {
+    return indices.size() / 3;
+}
+bool CompactTriangleMesh::hasNormals() const {
+    return withNormals;
+}
+bool CompactTriangleMesh::hasTextureCoordinates() const {
+    return withTextureCoordinates;
+}
+bool CompactTriangleMesh::empty() const {
+    return indices.empty();
+}
+
+MPM_NAMESPACE_END
@@ -0,0 +1,176 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <mpm/Constitutive.h>
+#include <mpm/Svd.h>
+
+#include <algorithm>
+#include <cmath>
+
+MPM_NAMESPACE_BEGIN
+
+void computeAvx2Svd(SvdBatch &, size_t);
+void computeAvx512Svd(SvdBatch &, size_t);
+void computeAvx2Stresses(ConstitutiveModel, StressBatch &, size_t);
+void computeAvx512Stresses(ConstitutiveModel, StressBatch &, size_t);
+void computeAvx2ReturnMapping(PlasticityBatch &, size_t);
+void computeAvx512ReturnMapping(PlasticityBatch &, size_t);
+
+static const size_t PADDED_WIDTH = 16;
+
+struct ScalarLane {
+    typedef bool Mask;
+
+    static const size_t WIDTH = 1;
+
+    float value;
+
+    ScalarLane() {}
+    ScalarLane(float value) : value(value) {}
+
+    static ScalarLane load(const float * source) {
+        return *source;
+    }
+    static void store(float * target, const ScalarLane & x) {
+        *target = x.value;
+    }
+    static ScalarLane select(bool condition, const ScalarLane & x, const ScalarLane & y) {
+        return condition ? x : y;
+    }
+    static ScalarLane sqrt(const ScalarLane & x) {
+        return std::sqrt(x.value);
+    }
+    static ScalarLane rsqrt(const ScalarLane & x) {
+        return 1.0f / std::sqrt(x.value);
+    }
+    static ScalarLane abs(const ScalarLane & x) {
+        return std::abs(x.value);
+    }
+    static ScalarLane min(const ScalarLane & x, const ScalarLane & y) {
+        return std::min(x.value, y.value);
+    }
+    static ScalarLane max(const ScalarLane & x, const ScalarLane & y) {
+        return std::max(x.value, y.value);
+    }
+    static ScalarLane floor(const ScalarLane & x) {
+        return std::floor(x.value);
+    }
+    static ScalarLane ldexp(const ScalarLane & x, const ScalarLane & exponent) {
+        return std::ldexp(x.value, (int)exponent.value);
+    }
+    static ScalarLane frexp(const ScalarLane & x, ScalarLane & exponent) {
+        int power;
+        float mantissa = std::frexp(std::abs(x.value), &power);
+
+        exponent = (float)power;
+
+        return mantissa;
+    }
+};
+
+static ScalarLane operator+(const ScalarLane & x, const ScalarLane & y) {
+    return x.value + y.value;
+}
+static ScalarLane operator-(const ScalarLane & x, const ScalarLane & y) {
+    return x.value - y.value;
+}
+static ScalarLane operator*(const ScalarLane & x, const ScalarLane & y) {
+    return x.value * y.value;
+}
+static ScalarLane operator/(const ScalarLane & x, const ScalarLane & y) {
+    return x.value / y.value;
+}
+static ScalarLane operator-(const ScalarLane & x) {
+    return -x.value;
+}
+static bool operator<(const ScalarLane & x, const ScalarLane & y) {
+    return x.value < y.value;
+}
+
+static size_t padMatrices(float (&matrices)[9][KERNEL_BATCH_SIZE], size_t count) {
+    size_t padded = std::min(
+        (count + PADDED_WIDTH - 1) / PADDED_WIDTH * PADDED_WIDTH, KERNEL_BATCH_SIZE);
+
+    for (int i = 0; i < 9; i++)
+        std::fill(matrices[i] + count, matrices[i] + padded, i % 4 == 0 ? 1.0f : 0.0f);
+
+    return padded;
+}
+
+void Constitutive::computeSvd(SvdBatch & batch, size_t count) {
+    InstructionSet instructionSet = Kernel::getInstructionSet();
+
+    if (instructionSet == InstructionSet::Scalar) {
+        computeSvdBatch<ScalarLane>(batch, count);
+        return;
+    }
+
+    count = padMatrices(batch.matrices, count);
+
+    if (instructionSet == InstructionSet::Avx512)
+        computeAvx512Svd(batch, count);
+    else
+        computeAvx2Svd(batch, count);
+}
+void Constitutive::computeStresses(ConstitutiveModel model, StressBatch & batch, size_t count) {
+    InstructionSet instructionSet = Kernel::getInstructionSet();
+
+    if (instructionSet == InstructionSet::Scalar) {
+        computeStressBatch<ScalarLane>(model, batch, count);
+        return;
+    }
+
+    size_t padded = padMatrices(batch.deformationGradients, count);
+
+    std::fill(batch.lambdas + count, batch.lambdas + padded, 0.0f);
+    std::fill(batch.mus + count, batch.mus + padded, 0.0f);
+
+    if (instructionSet == InstructionSet::Avx512)
+        computeAvx512Stresses(model, batch, padded);
+    else
+        computeAvx2Stresses(model, batch, padded);
+}
+void Constitutive::computeReturnMapping(PlasticityBatch & batch, size_t count) {
+    InstructionSet instructionSet = Kernel::getInstructionSet();
+
+    if (instructionSet == InstructionSet::Scalar) {
+        computeReturnMappingBatch<ScalarLane>(batch, count);
+        return;
+    }
+
+    size_t padded = padMatrices(batch.deformationGradients, count);
+
+    std::fill(batch.yieldStrains + count, batch.yieldStrains + padded, 0.0f);
+    std::fill(batch.relaxations + count, batch.relaxations + padded, 0.0f);
+
+    if (instructionSet == InstructionSet::Avx512)
+        computeAvx512ReturnMapping(batch, padded);
+    else
+        computeAvx2ReturnMapping(batch, padded);
+}
+
+MPM_NAMESPACE_END
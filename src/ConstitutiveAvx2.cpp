@@ -0,0 +1,139 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC target("avx2")
+#endif
+
+#include <mpm/Constitutive.h>
+#include <mpm/Svd.h>
+
+#include <immintrin.h>
+
+MPM_NAMESPACE_BEGIN
+
+struct Avx2Mask {
+    __m256 value;
+
+    Avx2Mask(__m256 value) : value(value) {}
+};
+
+struct Avx2Lane {
+    typedef Avx2Mask Mask;
+
+    static const size_t WIDTH = 8;
+
+    __m256 value;
+
+    Avx2Lane() {}
+    Avx2Lane(float value) : value(_mm256_set1_ps(value)) {}
+    Avx2Lane(__m256 value) : value(value) {}
+
+    static Avx2Lane load(const float * source) {
+        return _mm256_load_ps(source);
+    }
+    static void store(float * target, const Avx2Lane & x) {
+        _mm256_store_ps(target, x.value);
+    }
+    static Avx2Lane select(const Avx2Mask & condition, const Avx2Lane & x, const Avx2Lane & y) {
+        return _mm256_blendv_ps(y.value, x.value, condition.value);
+    }
+    static Avx2Lane sqrt(const Avx2Lane & x) {
+        return _mm256_sqrt_ps(x.value);
+    }
+    static Avx2Lane rsqrt(const Avx2Lane & x) {
+        __m256 estimate = _mm256_rsqrt_ps(x.value);
+        __m256 correction = _mm256_mul_ps(_mm256_mul_ps(x.value, estimate), estimate);
+
+        return _mm256_mul_ps(estimate, _mm256_sub_ps(
+            _mm256_set1_ps(1.5f), _mm256_mul_ps(_mm256_set1_ps(0.5f), correction)));
+    }
+    static Avx2Lane abs(const Avx2Lane & x) {
+        return _mm256_and_ps(x.value, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff)));
+    }
+    static Avx2Lane min(const Avx2Lane & x, const Avx2Lane & y) {
+        return _mm256_min_ps(x.value, y.value);
+    }
+    static Avx2Lane max(const Avx2Lane & x, const Avx2Lane & y) {
+        return _mm256_max_ps(x.value, y.value);
+    }
+    static Avx2Lane floor(const Avx2Lane & x) {
+        return _mm256_floor_ps(x.value);
+    }
+    static Avx2Lane ldexp(const Avx2Lane & x, const Avx2Lane & exponent) {
+        __m256i bits = _mm256_slli_epi32(_mm256_add_epi32(
+            _mm256_cvtps_epi32(exponent.value), _mm256_set1_epi32(127)), 23);
+
+        return _mm256_mul_ps(x.value, _mm256_castsi256_ps(bits));
+    }
+    static Avx2Lane frexp(const Avx2Lane & x, Avx2Lane & exponent) {
+        __m256i bits = _mm256_and_si256(_mm256_castps_si256(x.value), _mm256_set1_epi32(0x7fffffff));
+
+        exponent = _mm256_cvtepi32_ps(_mm256_sub_epi32(
+            _mm256_srli_epi32(bits, 23), _mm256_set1_epi32(126)));
+
+        return _mm256_castsi256_ps(_mm256_or_si256(
+            _mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)), _mm256_set1_epi32(0x3f000000)));
+    }
+};
+
+static Avx2Lane operator+(const Avx2Lane & x, const Avx2Lane & y) {
+    return _mm256_add_ps(x.value, y.value);
+}
+static Avx2Lane operator-(const Avx2Lane & x, const Avx2Lane & y) {
+    return _mm256_sub_ps(x.value, y.value);
+}
+static Avx2Lane operator*(const Avx2Lane & x, const Avx2Lane & y) {
+    return _mm256_mul_ps(x.value, y.value);
+}
+static Avx2Lane operator/(const Avx2Lane & x, const Avx2Lane & y) {
+    return _mm256_div_ps(x.value, y.value);
+}
+static Avx2Lane operator-(const Avx2Lane & x) {
+    return _mm256_xor_ps(x.value, _mm256_set1_ps(-0.0f));
+}
+static Avx2Mask operator<(const Avx2Lane & x, const Avx2Lane & y) {
+    return _mm256_cmp_ps(x.value, y.value, _CMP_LT_OQ);
+}
+
+void computeAvx2Svd(SvdBatch & batch, size_t count) {
+    computeSvdBatch<Avx2Lane>(batch, count);
+}
+void computeAvx2Stresses(ConstitutiveModel model, StressBatch & batch, size_t count) {
+    computeStressBatch<Avx2Lane>(model, batch, count);
+}
+void computeAvx2ReturnMapping(PlasticityBatch & batch, size_t count) {
+    computeReturnMappingBatch<Avx2Lane>(batch, count);
+}
+
+MPM_NAMESPACE_END
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#endif
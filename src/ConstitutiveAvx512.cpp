@@ -0,0 +1,146 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx512f"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC target("avx512f")
+#endif
+
+#include <mpm/Constitutive.h>
+#include <mpm/Svd.h>
+
+#include <immintrin.h>
+
+MPM_NAMESPACE_BEGIN
+
+#if defined(MPM_AVX512_KERNEL)
+
+struct Avx512Mask {
+    __mmask16 value;
+
+    Avx512Mask(__mmask16 value) : value(value) {}
+};
+
+struct Avx512Lane {
+    typedef Avx512Mask Mask;
+
+    static const size_t WIDTH = 16;
+
+    __m512 value;
+
+    Avx512Lane() {}
+    Avx512Lane(float value) : value(_mm512_set1_ps(value)) {}
+    Avx512Lane(__m512 value) : value(value) {}
+
+    static Avx512Lane load(const float * source) {
+        return _mm512_load_ps(source);
+    }
+    static void store(float * target, const Avx512Lane & x) {
+        _mm512_store_ps(target, x.value);
+    }
+    static Avx512Lane select(const Avx512Mask & condition, const Avx512Lane & x, const Avx512Lane & y) {
+        return _mm512_mask_blend_ps(condition.value, y.value, x.value);
+    }
+    static Avx512Lane sqrt(const Avx512Lane & x) {
+        return _mm512_sqrt_ps(x.value);
+    }
+    static Avx512Lane rsqrt(const Avx512Lane & x) {
+        __m512 estimate = _mm512_rsqrt14_ps(x.value);
+        __m512 correction = _mm512_mul_ps(_mm512_mul_ps(x.value, estimate), estimate);
+
+        return _mm512_mul_ps(estimate, _mm512_sub_ps(
+            _mm512_set1_ps(1.5f), _mm512_mul_ps(_mm512_set1_ps(0.5f), correction)));
+    }
+    static Avx512Lane abs(const Avx512Lane & x) {
+        return _mm512_abs_ps(x.value);
+    }
+    static Avx512Lane min(const Avx512Lane & x, const Avx512Lane & y) {
+        return _mm512_min_ps(x.value, y.value);
+    }
+    static Avx512Lane max(const Avx512Lane & x, const Avx512Lane & y) {
+        return _mm512_max_ps(x.value, y.value);
+    }
+    static Avx512Lane floor(const Avx512Lane & x) {
+        return _mm512_roundscale_ps(x.value, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    }
+    static Avx512Lane ldexp(const Avx512Lane & x, const Avx512Lane & exponent) {
+        return _mm512_scalef_ps(x.value, exponent.value);
+    }
+    static Avx512Lane frexp(const Avx512Lane & x, Avx512Lane & exponent) {
+        __m512i bits = _mm512_and_si512(_mm512_castps_si512(x.value), _mm512_set1_epi32(0x7fffffff));
+
+        exponent = _mm512_cvtepi32_ps(_mm512_sub_epi32(
+            _mm512_srli_epi32(bits, 23), _mm512_set1_epi32(126)));
+
+        return _mm512_castsi512_ps(_mm512_or_si512(
+            _mm512_and_si512(bits, _mm512_set1_epi32(0x007fffff)), _mm512_set1_epi32(0x3f000000)));
+    }
+};
+
+static Avx512Lane operator+(const Avx512Lane & x, const Avx512Lane & y) {
+    return _mm512_add_ps(x.value, y.value);
+}
+static Avx512Lane operator-(const Avx512Lane & x, const Avx512Lane & y) {
+    return _mm512_sub_ps(x.value, y.value);
+}
+static Avx512Lane operator*(const Avx512Lane & x, const Avx512Lane & y) {
+    return _mm512_mul_ps(x.value, y.value);
+}
+static Avx512Lane operator/(const Avx512Lane & x, const Avx512Lane & y) {
+    return _mm512_div_ps(x.value, y.value);
+}
+static Avx512Lane operator-(const Avx512Lane & x) {
+    return _mm512_sub_ps(_mm512_setzero_ps(), x.value);
+}
+static Avx512Mask operator<(const Avx512Lane & x, const Avx512Lane & y) {
+    return _mm512_cmp_ps_mask(x.value, y.value, _CMP_LT_OQ);
+}
+
+void computeAvx512Svd(SvdBatch & batch, size_t count) {
+    computeSvdBatch<Avx512Lane>(batch, count);
+}
+void computeAvx512Stresses(ConstitutiveModel model, StressBatch & batch, size_t count) {
+    computeStressBatch<Avx512Lane>(model, batch, count);
+}
+void computeAvx512ReturnMapping(PlasticityBatch & batch, size_t count) {
+    computeReturnMappingBatch<Avx512Lane>(batch, count);
+}
+
+#else
+
+void computeAvx512Svd(SvdBatch &, size_t) {}
+void computeAvx512Stresses(ConstitutiveModel, StressBatch &, size_t) {}
+void computeAvx512ReturnMapping(PlasticityBatch &, size_t) {}
+
+#endif
+
+MPM_NAMESPACE_END
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#endif
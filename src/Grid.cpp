@@ -0,0 +1,356 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <mpm/Grid.h>
+
+#include <glm/common.hpp>
+
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+
+#include <algorithm>
+#include <limits>
+
+MPM_NAMESPACE_BEGIN
+
+static const uint64_t EMPTY_KEY = std::numeric_limits<uint64_t>::max();
+static const int KEY_BITS = 21;
+static const int KEY_BIAS = 1 << (KEY_BITS - 1);
+static const uint64_t KEY_MASK = (1ull << KEY_BITS) - 1;
+
+Grid::Block & Grid::Block::clear() {
+    std::fill(mass, mass + BLOCK_VOLUME, 0.0f);
+    std::fill(momentum, momentum + BLOCK_VOLUME, glm::vec3(0));
+    std::fill(velocity, velocity + BLOCK_VOLUME, glm::vec3(0));
+
+    return *this;
+}
+Grid::Block & Grid::Block::accumulate(const Block & block) {
+    for (size_t i = 0; i < BLOCK_VOLUME; i++) {
+        mass[i] += block.mass[i];
+        momentum[i] += block.momentum[i];
+    }
+
+    return *this;
+}
+
+Grid::Neighborhood::Neighborhood() {
+    std::fill(blocks, blocks + 8, nullptr);
+}
+
+Grid::Neighborhood & Grid::Neighborhood::fetch(
+    const Grid & grid, const glm::ivec3 & coordinate) {
+    for (int i = 0; i < 8; i++) {
+        if ((i & 1) && grid.dimension == 2)
+            blocks[i] = nullptr;
+        else
+            blocks[i] = grid.findBlock(coordinate + glm::ivec3(i >> 2, (i >> 1) & 1, i & 1));
+    }
+
+    return *this;
+}
+
+Grid::LocalBuffer::LocalBuffer() : blockCount(0) {}
+
+Grid::LocalBuffer & Grid::LocalBuffer::reset(size_t gridBlockCount) {
+    slots.assign(gridBlockCount, -1);
+    blockCount = 0;
+
+    return *this;
+}
+Grid::LocalBuffer & Grid::LocalBuffer::redirect(const Grid & grid, Neighborhood & neighborhood) {
+    if (slots.size() != grid.getBlockCount())
+        reset(grid.getBlockCount());
+
+    for (int i = 0; i < 8; i++) {
+        if (neighborhood.blocks[i])
+            neighborhood.blocks[i] = &getBlock(*neighborhood.blocks[i]);
+    }
+
+    return *this;
+}
+
+const Grid::Block * Grid::LocalBuffer::findBlock(size_t index) const {
+    if (index >= slots.size() || slots[index] < 0)
+        return nullptr;
+
+    return blocks[slots[index]].get();
+}
+
+Grid::Block & Grid::LocalBuffer::getBlock(const Block & block) {
+    int32_t & slot = slots[block.index];
+
+    if (slot < 0) {
+        if (blockCount == blocks.size())
+            blocks.emplace_back(new Block());
+
+        slot = (int32_t)blockCount++;
+
+        Block & local = *blocks[slot];
+        local.coordinate = block.coordinate;
+        local.index = block.index;
+        local.clear();
+    }
+
+    return *blocks[slot];
+}
+
+Grid::Grid() : spacing(1.0), dimension(3), blockCount(0), tableMask(0) {}
+Grid::~Grid() {}
+
+Grid & Grid::activate(Span<const glm::vec3> positions, Interpolation interpolation) {
+    float inverseSpacing = 1.0 / spacing;
+    float offset = Kernel::getStencilOffset(interpolation);
+    int extent = (int)Kernel::getStencilSize(interpolation) - 1;
+    glm::ivec3 extents(extent, extent, dimension == 3 ? extent : 0);
+
+    tbb::enumerable_thread_specific<std::vector<uint64_t>> localKeys;
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, positions.size()),
+        [&](const tbb::blocked_range<size_t> & range) {
+        std::vector<uint64_t> & keys = localKeys.local();
+
+        glm::ivec3 previousFirst(std::numeric_limits<int>::max());
+        glm::ivec3 previousLast(std::numeric_limits<int>::max());
+
+        for (size_t p = range.begin(); p < range.end(); p++) {
+            glm::ivec3 base = glm::ivec3(glm::floor(positions[p] * inverseSpacing - offset));
+            glm::ivec3 first = getBlockCoordinate(base);
+            glm::ivec3 last = getBlockCoordinate(base + extents);
+
+            if (first == previousFirst && last == previousLast)
+                continue;
+
+            for (int x = first.x; x <= last.x; x++) {
+                for (int y = first.y; y <= last.y; y++) {
+                    for (int z = first.z; z <= last.z; z++)
+                        keys.push_back(getKey(glm::ivec3(x, y, z)));
+                }
+            }
+
+            previousFirst = first;
+            previousLast = last;
+        }
+    });
+
+    return allocate(localKeys);
+}
+Grid & Grid::coarsen(const Grid & grid, Span<const float> masses) {
+    spacing = 2.0f * grid.spacing;
+    dimension = grid.dimension;
+
+    glm::ivec3 size = getBlockSize();
+    glm::ivec3 ratio = getCoarseningRatio();
+
+    tbb::enumerable_thread_specific<std::vector<uint64_t>> localKeys;
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, grid.blockCount),
+        [&](const tbb::blocked_range<size_t> & range) {
+        std::vector<uint64_t> & keys = localKeys.local();
+
+        for (size_t b = range.begin(); b < range.end(); b++) {
+            const float * blockMasses = &masses[b * BLOCK_VOLUME];
+
+            if (std::none_of(blockMasses, blockMasses + BLOCK_VOLUME,
+                [](float mass) { return mass > 0; }))
+                continue;
+
+            glm::ivec3 node = grid.blocks[b]->coordinate * size;
+            glm::ivec3 first = getBlockCoordinate(node / ratio);
+            glm::ivec3 last = getBlockCoordinate((node + size + ratio - 2) / ratio);
+
+            for (int x = first.x; x <= last.x; x++) {
+                for (int y = first.y; y <= last.y; y++) {
+                    for (int z = first.z; z <= last.z; z++)
+                        keys.push_back(getKey(glm::ivec3(x, y, z)));
+                }
+            }
+        }
+    });
+
+    return allocate(localKeys);
+}
+Grid & Grid::allocate(tbb::enumerable_thread_specific<std::vector<uint64_t>> & localKeys) {
+    std::vector<uint64_t> keys;
+
+    for (const std::vector<uint64_t> & local : localKeys)
+        keys.insert(keys.end(), local.begin(), local.end());
+
+    tbb::parallel_sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    blockCount = keys.size();
+
+    while (blocks.size() < blockCount)
+        blocks.emplace_back(new Block());
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, blockCount),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t i = range.begin(); i < range.end(); i++) {
+            uint64_t key = keys[i];
+
+            blocks[i]->coordinate = glm::ivec3(
+                (int)(key & KEY_MASK) - KEY_BIAS,
+                (int)((key >> KEY_BITS) & KEY_MASK) - KEY_BIAS,
+                (int)((key >> (2 * KEY_BITS)) & KEY_MASK) - KEY_BIAS);
+            blocks[i]->index = i;
+            blocks[i]->clear();
+        }
+    });
+
+    return buildTable();
+}
+Grid & Grid::clear() {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, blockCount),
+        [this](const tbb::blocked_range<size_t> & range) {
+        for (size_t i = range.begin(); i < range.end(); i++)
+            blocks[i]->clear();
+    });
+
+    return *this;
+}
+
+Grid & Grid::reduce(const std::vector<const LocalBuffer *> & buffers) {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, blockCount),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t i = range.begin(); i < range.end(); i++) {
+            for (const LocalBuffer * buffer : buffers) {
+                const Block * block = buffer->findBlock(i);
+
+                if (block)
+                    blocks[i]->accumulate(*block);
+            }
+        }
+    });
+
+    return *this;
+}
+
+Grid::Block * Grid::findBlock(const glm::ivec3 & coordinate) const {
+    if (tableKeys.empty())
+        return nullptr;
+
+    uint64_t key = getKey(coordinate);
+
+    for (uint64_t slot = getHash(key) & tableMask;; slot = (slot + 1) & tableMask) {
+        uint64_t current = tableKeys[slot];
+
+        if (current == key)
+            return blocks[tableValues[slot]].get();
+        if (current == EMPTY_KEY)
+            return nullptr;
+    }
+}
+Grid::Block & Grid::getBlock(size_t i) {
+    return *blocks[i];
+}
+const Grid::Block & Grid::getBlock(size_t i) const {
+    return *blocks[i];
+}
+glm::vec3 Grid::getPosition(const Block & block, size_t i) const {
+    return glm::vec3(block.coordinate * getBlockSize() + getNodeCoordinate(i)) * spacing;
+}
+
+Grid & Grid::setSpacing(float spacing) {
+    this->spacing = spacing;
+    return *this;
+}
+Grid & Grid::setDimension(int dimension) {
+    this->dimension = dimension;
+    return *this;
+}
+
+float Grid::getSpacing() const {
+    return spacing;
+}
+int Grid::getDimension() const {
+    return dimension;
+}
+size_t Grid::getBlockCount() const {
+    return blockCount;
+}
+size_t Grid::getBlockCapacity() const {
+    return blocks.size();
+}
+size_t Grid::getNodeCount() const {
+    return blockCount * BLOCK_VOLUME;
+}
+
+glm::ivec3 Grid::getBlockSize() const {
+    return dimension == 2 ? Layout<2>::getBlockSize() : Layout<3>::getBlockSize();
+}
+glm::ivec3 Grid::getCoarseningRatio() const {
+    return dimension == 2 ? Layout<2>::getCoarseningRatio() : Layout<3>::getCoarseningRatio();
+}
+size_t Grid::getNodeIndex(const glm::ivec3 & node) const {
+    return dimension == 2 ? Layout<2>::getNodeIndex(node.x, node.y, node.z)
+        : Layout<3>::getNodeIndex(node.x, node.y, node.z);
+}
+glm::ivec3 Grid::getNodeCoordinate(size_t i) const {
+    return dimension == 2 ? Layout<2>::getNodeCoordinate(i) : Layout<3>::getNodeCoordinate(i);
+}
+glm::ivec3 Grid::getBlockCoordinate(const glm::ivec3 & node) const {
+    return dimension == 2 ? Layout<2>::getBlockCoordinate(node) : Layout<3>::getBlockCoordinate(node);
+}
+
+uint64_t Grid::getKey(const glm::ivec3 & coordinate) {
+    return (uint64_t)(coordinate.x + KEY_BIAS)
+        | ((uint64_t)(coordinate.y + KEY_BIAS) << KEY_BITS)
+        | ((uint64_t)(coordinate.z + KEY_BIAS) << (2 * KEY_BITS));
+}
+uint64_t Grid::getHash(uint64_t key) {
+    key *= 0x9e3779b97f4a7c15ull;
+    return key ^ (key >> 32);
+}
+
+Grid & Grid::buildTable() {
+    size_t capacity = 16;
+
+    while (capacity < 2 * blockCount)
+        capacity <<= 1;
+
+    tableMask = capacity - 1;
+    tableKeys.assign(capacity, EMPTY_KEY);
+    tableValues.resize(capacity);
+
+    for (size_t i = 0; i < blockCount; i++) {
+        uint64_t key = getKey(blocks[i]->coordinate);
+        uint64_t slot = getHash(key) & tableMask;
+
+        while (tableKeys[slot] != EMPTY_KEY)
+            slot = (slot + 1) & tableMask;
+
+        tableKeys[slot] = key;
+        tableValues[slot] = (uint32_t)i;
+    }
+
+    return *this;
+}
+
+MPM_NAMESPACE_END
@@ -0,0 +1,203 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <mpm/Kernel.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+MPM_NAMESPACE_BEGIN
+
+bool hasAvx2Kernel();
+bool hasAvx512Kernel();
+void computeAvx2Weights(Interpolation, const float *, float, KernelBatch &);
+void computeAvx512Weights(Interpolation, const float *, float, KernelBatch &);
+
+static InstructionSet detectInstructionSet() {
+#if defined(_MSC_VER)
+    int info[4];
+
+    __cpuid(info, 0);
+
+    if (info[0] < 7)
+        return InstructionSet::Scalar;
+
+    __cpuid(info, 1);
+
+    if (!(info[2] & (1 << 27)) || !(info[2] & (1 << 28)))
+        return InstructionSet::Scalar;
+
+    unsigned long long xcr0 = _xgetbv(0);
+
+    __cpuidex(info, 7, 0);
+
+    bool avx2 = (info[1] & (1 << 5)) && (xcr0 & 0x6) == 0x6;
+    bool avx512 = (info[1] & (1 << 16)) && (xcr0 & 0xe6) == 0xe6;
+#else
+    __builtin_cpu_init();
+
+    bool avx2 = __builtin_cpu_supports("avx2");
+    bool avx512 = __builtin_cpu_supports("avx512f");
+#endif
+
+    if (avx512 && hasAvx512Kernel())
+        return InstructionSet::Avx512;
+    if (avx2 && hasAvx2Kernel())
+        return InstructionSet::Avx2;
+
+    return InstructionSet::Scalar;
+}
+
+static std::atomic<InstructionSet> & getSelectedInstructionSet() {
+    static std::atomic<InstructionSet> instructionSet(Kernel::getSupportedInstructionSet());
+    return instructionSet;
+}
+
+static void computeScalarWeights(
+    Interpolation interpolation, const float * positions, size_t count,
+    float inverseSpacing, KernelBatch & batch) {
+    for (size_t p = 0; p < count; p++) {
+        for (int axis = 0; axis < 3; axis++) {
+            float cell = positions[3 * p + axis] * inverseSpacing;
+
+            float (&weights)[KERNEL_STENCIL_SIZE][KERNEL_BATCH_SIZE] = batch.weights[axis];
+            float (&gradients)[KERNEL_STENCIL_SIZE][KERNEL_BATCH_SIZE] = batch.gradients[axis];
+
+            if (interpolation == Interpolation::Linear) {
+                float base = std::floor(cell);
+                float fx = cell - base;
+
+                batch.bases[axis][p] = (int)base;
+
+                weights[0][p] = 1.0f - fx;
+                weights[1][p] = fx;
+
+                gradients[0][p] = -inverseSpacing;
+                gradients[1][p] = inverseSpacing;
+            }
+            else if (interpolation == Interpolation::Quadratic) {
+                float base = std::floor(cell - 0.5f);
+                float fx = cell - base;
+
+                batch.bases[axis][p] = (int)base;
+
+                weights[0][p] = 0.5f * (1.5f - fx) * (1.5f - fx);
+                weights[1][p] = 0.75f - (fx - 1.0f) * (fx - 1.0f);
+                weights[2][p] = 0.5f * (fx - 0.5f) * (fx - 0.5f);
+
+                gradients[0][p] = (fx - 1.5f) * inverseSpacing;
+                gradients[1][p] = -2.0f * (fx - 1.0f) * inverseSpacing;
+                gradients[2][p] = (fx - 0.5f) * inverseSpacing;
+            }
+            else {
+                float base = std::floor(cell - 1.0f);
+                float fx = cell - base;
+
+                float a = 2.0f - fx;
+                float b = fx - 1.0f;
+                float c = fx - 2.0f;
+
+                batch.bases[axis][p] = (int)base;
+
+                weights[0][p] = a * a * a / 6.0f;
+                weights[1][p] = 0.5f * b * b * b - b * b + 2.0f / 3.0f;
+                weights[2][p] = -0.5f * c * c * c - c * c + 2.0f / 3.0f;
+                weights[3][p] = b * b * b / 6.0f;
+
+                gradients[0][p] = -0.5f * a * a * inverseSpacing;
+                gradients[1][p] = (1.5f * b * b - 2.0f * b) * inverseSpacing;
+                gradients[2][p] = (-1.5f * c * c - 2.0f * c) * inverseSpacing;
+                gradients[3][p] = 0.5f * b * b * inverseSpacing;
+            }
+        }
+    }
+}
+
+InstructionSet Kernel::getSupportedInstructionSet() {
+    static const InstructionSet instructionSet = detectInstructionSet();
+    return instructionSet;
+}
+InstructionSet Kernel::getInstructionSet() {
+    return getSelectedInstructionSet().load(std::memory_order_relaxed);
+}
+InstructionSet Kernel::setInstructionSet(InstructionSet instructionSet) {
+    InstructionSet supported = getSupportedInstructionSet();
+
+    if ((int)instructionSet > (int)supported)
+        instructionSet = supported;
+
+    getSelectedInstructionSet().store(instructionSet, std::memory_order_relaxed);
+
+    return instructionSet;
+}
+
+size_t Kernel::getStencilSize(Interpolation interpolation) {
+    switch (interpolation) {
+    case Interpolation::Linear:
+        return Stencil<Interpolation::Linear>::SIZE;
+    case Interpolation::Quadratic:
+        return Stencil<Interpolation::Quadratic>::SIZE;
+    default:
+        return Stencil<Interpolation::Cubic>::SIZE;
+    }
+}
+float Kernel::getStencilOffset(Interpolation interpolation) {
+    return 0.5f * (float)(getStencilSize(interpolation) - 2);
+}
+
+void Kernel::computeWeights(
+    Interpolation interpolation, const float * positions, size_t count,
+    float inverseSpacing, KernelBatch & batch) {
+    InstructionSet instructionSet = getInstructionSet();
+
+    if (instructionSet == InstructionSet::Scalar) {
+        computeScalarWeights(interpolation, positions, count, inverseSpacing, batch);
+        return;
+    }
+
+    float padded[3 * KERNEL_BATCH_SIZE];
+
+    if (count < KERNEL_BATCH_SIZE) {
+        std::copy(positions, positions + 3 * count, padded);
+        std::fill(padded + 3 * count, padded + 3 * KERNEL_BATCH_SIZE, 0.0f);
+
+        positions = padded;
+    }
+
+    if (instructionSet == InstructionSet::Avx512)
+        computeAvx512Weights(interpolation, positions, inverseSpacing, batch);
+    else
+        computeAvx2Weights(interpolation, positions, inverseSpacing, batch);
+}
+
+MPM_NAMESPACE_END
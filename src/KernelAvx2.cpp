@@ -0,0 +1,156 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC target("avx2")
+#endif
+
+#include <mpm/Kernel.h>
+
+#include <immintrin.h>
+
+MPM_NAMESPACE_BEGIN
+
+static const size_t AVX2_LANES = 8;
+
+static void storeLinearWeights(
+    __m256 cell, __m256 scale, float * weights[2], float * gradients[2], int * bases) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    __m256 base = _mm256_floor_ps(cell);
+    __m256 fx = _mm256_sub_ps(cell, base);
+
+    _mm256_store_si256((__m256i *)bases, _mm256_cvtps_epi32(base));
+
+    _mm256_store_ps(weights[0], _mm256_sub_ps(one, fx));
+    _mm256_store_ps(weights[1], fx);
+
+    _mm256_store_ps(gradients[0], _mm256_sub_ps(_mm256_setzero_ps(), scale));
+    _mm256_store_ps(gradients[1], scale);
+}
+static void storeQuadraticWeights(
+    __m256 cell, __m256 scale, float * weights[3], float * gradients[3], int * bases) {
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 threeHalves = _mm256_set1_ps(1.5f);
+    const __m256 threeQuarters = _mm256_set1_ps(0.75f);
+    const __m256 minusTwo = _mm256_set1_ps(-2.0f);
+
+    __m256 base = _mm256_floor_ps(_mm256_sub_ps(cell, half));
+    __m256 fx = _mm256_sub_ps(cell, base);
+
+    __m256 a = _mm256_sub_ps(threeHalves, fx);
+    __m256 b = _mm256_sub_ps(fx, one);
+    __m256 c = _mm256_sub_ps(fx, half);
+
+    _mm256_store_si256((__m256i *)bases, _mm256_cvtps_epi32(base));
+
+    _mm256_store_ps(weights[0], _mm256_mul_ps(half, _mm256_mul_ps(a, a)));
+    _mm256_store_ps(weights[1], _mm256_sub_ps(threeQuarters, _mm256_mul_ps(b, b)));
+    _mm256_store_ps(weights[2], _mm256_mul_ps(half, _mm256_mul_ps(c, c)));
+
+    _mm256_store_ps(gradients[0], _mm256_mul_ps(_mm256_sub_ps(fx, threeHalves), scale));
+    _mm256_store_ps(gradients[1], _mm256_mul_ps(_mm256_mul_ps(minusTwo, b), scale));
+    _mm256_store_ps(gradients[2], _mm256_mul_ps(c, scale));
+}
+static void storeCubicWeights(
+    __m256 cell, __m256 scale, float * weights[4], float * gradients[4], int * bases) {
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 two = _mm256_set1_ps(2.0f);
+    const __m256 threeHalves = _mm256_set1_ps(1.5f);
+    const __m256 sixth = _mm256_set1_ps(1.0f / 6.0f);
+    const __m256 twoThirds = _mm256_set1_ps(2.0f / 3.0f);
+
+    __m256 base = _mm256_floor_ps(_mm256_sub_ps(cell, one));
+    __m256 fx = _mm256_sub_ps(cell, base);
+
+    __m256 a = _mm256_sub_ps(two, fx);
+    __m256 b = _mm256_sub_ps(fx, one);
+    __m256 c = _mm256_sub_ps(fx, two);
+
+    __m256 a2 = _mm256_mul_ps(a, a);
+    __m256 b2 = _mm256_mul_ps(b, b);
+    __m256 c2 = _mm256_mul_ps(c, c);
+
+    _mm256_store_si256((__m256i *)bases, _mm256_cvtps_epi32(base));
+
+    _mm256_store_ps(weights[0], _mm256_mul_ps(sixth, _mm256_mul_ps(a2, a)));
+    _mm256_store_ps(weights[1], _mm256_add_ps(
+        _mm256_sub_ps(_mm256_mul_ps(half, _mm256_mul_ps(b2, b)), b2), twoThirds));
+    _mm256_store_ps(weights[2], _mm256_sub_ps(
+        twoThirds, _mm256_add_ps(_mm256_mul_ps(half, _mm256_mul_ps(c2, c)), c2)));
+    _mm256_store_ps(weights[3], _mm256_mul_ps(sixth, _mm256_mul_ps(b2, b)));
+
+    _mm256_store_ps(gradients[0], _mm256_mul_ps(_mm256_mul_ps(half, a2), _mm256_sub_ps(_mm256_setzero_ps(), scale)));
+    _mm256_store_ps(gradients[1], _mm256_mul_ps(
+        _mm256_sub_ps(_mm256_mul_ps(threeHalves, b2), _mm256_mul_ps(two, b)), scale));
+    _mm256_store_ps(gradients[2], _mm256_mul_ps(
+        _mm256_sub_ps(_mm256_setzero_ps(), _mm256_add_ps(_mm256_mul_ps(threeHalves, c2), _mm256_mul_ps(two, c))), scale));
+    _mm256_store_ps(gradients[3], _mm256_mul_ps(_mm256_mul_ps(half, b2), scale));
+}
+
+bool hasAvx2Kernel() {
+    return true;
+}
+
+void computeAvx2Weights(
+    Interpolation interpolation, const float * positions,
+    float inverseSpacing, KernelBatch & batch) {
+    const __m256i indices = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+    const __m256 scale = _mm256_set1_ps(inverseSpacing);
+
+    for (size_t p = 0; p < KERNEL_BATCH_SIZE; p += AVX2_LANES) {
+        for (int axis = 0; axis < 3; axis++) {
+            __m256 cell = _mm256_mul_ps(
+                _mm256_i32gather_ps(positions + 3 * p + axis, indices, 4), scale);
+
+            float * weights[KERNEL_STENCIL_SIZE];
+            float * gradients[KERNEL_STENCIL_SIZE];
+
+            for (size_t i = 0; i < KERNEL_STENCIL_SIZE; i++) {
+                weights[i] = &batch.weights[axis][i][p];
+                gradients[i] = &batch.gradients[axis][i][p];
+            }
+
+            if (interpolation == Interpolation::Linear)
+                storeLinearWeights(cell, scale, weights, gradients, &batch.bases[axis][p]);
+            else if (interpolation == Interpolation::Quadratic)
+                storeQuadraticWeights(cell, scale, weights, gradients, &batch.bases[axis][p]);
+            else
+                storeCubicWeights(cell, scale, weights, gradients, &batch.bases[axis][p]);
+        }
+    }
+}
+
+MPM_NAMESPACE_END
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#endif
@@ -0,0 +1,167 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx512f"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC target("avx512f")
+#endif
+
+#include <mpm/Kernel.h>
+
+#include <immintrin.h>
+
+MPM_NAMESPACE_BEGIN
+
+#if defined(MPM_AVX512_KERNEL)
+
+static const size_t AVX512_LANES = 16;
+
+static void storeLinearWeights(
+    __m512 cell, __m512 scale, float * weights[2], float * gradients[2], int * bases) {
+    const __m512 one = _mm512_set1_ps(1.0f);
+
+    __m512 base = _mm512_roundscale_ps(cell, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    __m512 fx = _mm512_sub_ps(cell, base);
+
+    _mm512_store_si512(bases, _mm512_cvtps_epi32(base));
+
+    _mm512_store_ps(weights[0], _mm512_sub_ps(one, fx));
+    _mm512_store_ps(weights[1], fx);
+
+    _mm512_store_ps(gradients[0], _mm512_sub_ps(_mm512_setzero_ps(), scale));
+    _mm512_store_ps(gradients[1], scale);
+}
+static void storeQuadraticWeights(
+    __m512 cell, __m512 scale, float * weights[3], float * gradients[3], int * bases) {
+    const __m512 half = _mm512_set1_ps(0.5f);
+    const __m512 one = _mm512_set1_ps(1.0f);
+    const __m512 threeHalves = _mm512_set1_ps(1.5f);
+    const __m512 threeQuarters = _mm512_set1_ps(0.75f);
+    const __m512 minusTwo = _mm512_set1_ps(-2.0f);
+
+    __m512 base = _mm512_roundscale_ps(_mm512_sub_ps(cell, half), _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    __m512 fx = _mm512_sub_ps(cell, base);
+
+    __m512 a = _mm512_sub_ps(threeHalves, fx);
+    __m512 b = _mm512_sub_ps(fx, one);
+    __m512 c = _mm512_sub_ps(fx, half);
+
+    _mm512_store_si512(bases, _mm512_cvtps_epi32(base));
+
+    _mm512_store_ps(weights[0], _mm512_mul_ps(half, _mm512_mul_ps(a, a)));
+    _mm512_store_ps(weights[1], _mm512_sub_ps(threeQuarters, _mm512_mul_ps(b, b)));
+    _mm512_store_ps(weights[2], _mm512_mul_ps(half, _mm512_mul_ps(c, c)));
+
+    _mm512_store_ps(gradients[0], _mm512_mul_ps(_mm512_sub_ps(fx, threeHalves), scale));
+    _mm512_store_ps(gradients[1], _mm512_mul_ps(_mm512_mul_ps(minusTwo, b), scale));
+    _mm512_store_ps(gradients[2], _mm512_mul_ps(c, scale));
+}
+static void storeCubicWeights(
+    __m512 cell, __m512 scale, float * weights[4], float * gradients[4], int * bases) {
+    const __m512 half = _mm512_set1_ps(0.5f);
+    const __m512 one = _mm512_set1_ps(1.0f);
+    const __m512 two = _mm512_set1_ps(2.0f);
+    const __m512 threeHalves = _mm512_set1_ps(1.5f);
+    const __m512 sixth = _mm512_set1_ps(1.0f / 6.0f);
+    const __m512 twoThirds = _mm512_set1_ps(2.0f / 3.0f);
+
+    __m512 base = _mm512_roundscale_ps(_mm512_sub_ps(cell, one), _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    __m512 fx = _mm512_sub_ps(cell, base);
+
+    __m512 a = _mm512_sub_ps(two, fx);
+    __m512 b = _mm512_sub_ps(fx, one);
+    __m512 c = _mm512_sub_ps(fx, two);
+
+    __m512 a2 = _mm512_mul_ps(a, a);
+    __m512 b2 = _mm512_mul_ps(b, b);
+    __m512 c2 = _mm512_mul_ps(c, c);
+
+    _mm512_store_si512(bases, _mm512_cvtps_epi32(base));
+
+    _mm512_store_ps(weights[0], _mm512_mul_ps(sixth, _mm512_mul_ps(a2, a)));
+    _mm512_store_ps(weights[1], _mm512_add_ps(
+        _mm512_sub_ps(_mm512_mul_ps(half, _mm512_mul_ps(b2, b)), b2), twoThirds));
+    _mm512_store_ps(weights[2], _mm512_sub_ps(
+        twoThirds, _mm512_add_ps(_mm512_mul_ps(half, _mm512_mul_ps(c2, c)), c2)));
+    _mm512_store_ps(weights[3], _mm512_mul_ps(sixth, _mm512_mul_ps(b2, b)));
+
+    _mm512_store_ps(gradients[0], _mm512_mul_ps(_mm512_mul_ps(half, a2), _mm512_sub_ps(_mm512_setzero_ps(), scale)));
+    _mm512_store_ps(gradients[1], _mm512_mul_ps(
+        _mm512_sub_ps(_mm512_mul_ps(threeHalves, b2), _mm512_mul_ps(two, b)), scale));
+    _mm512_store_ps(gradients[2], _mm512_mul_ps(
+        _mm512_sub_ps(_mm512_setzero_ps(), _mm512_add_ps(_mm512_mul_ps(threeHalves, c2), _mm512_mul_ps(two, c))), scale));
+    _mm512_store_ps(gradients[3], _mm512_mul_ps(_mm512_mul_ps(half, b2), scale));
+}
+
+#endif
+
+bool hasAvx512Kernel() {
+#if defined(MPM_AVX512_KERNEL)
+    return true;
+#else
+    return false;
+#endif
+}
+
+void computeAvx512Weights(
+    Interpolation interpolation, const float * positions,
+    float inverseSpacing, KernelBatch & batch) {
+#if defined(MPM_AVX512_KERNEL)
+    const __m512i indices = _mm512_setr_epi32(
+        0, 3, 6, 9, 12, 15, 18, 21, 24, 27, 30, 33, 36, 39, 42, 45);
+    const __m512 scale = _mm512_set1_ps(inverseSpacing);
+
+    for (size_t p = 0; p < KERNEL_BATCH_SIZE; p += AVX512_LANES) {
+        for (int axis = 0; axis < 3; axis++) {
+            __m512 cell = _mm512_mul_ps(
+                _mm512_i32gather_ps(indices, positions + 3 * p + axis, 4), scale);
+
+            float * weights[KERNEL_STENCIL_SIZE];
+            float * gradients[KERNEL_STENCIL_SIZE];
+
+            for (size_t i = 0; i < KERNEL_STENCIL_SIZE; i++) {
+                weights[i] = &batch.weights[axis][i][p];
+                gradients[i] = &batch.gradients[axis][i][p];
+            }
+
+            if (interpolation == Interpolation::Linear)
+                storeLinearWeights(cell, scale, weights, gradients, &batch.bases[axis][p]);
+            else if (interpolation == Interpolation::Quadratic)
+                storeQuadraticWeights(cell, scale, weights, gradients, &batch.bases[axis][p]);
+            else
+                storeCubicWeights(cell, scale, weights, gradients, &batch.bases[axis][p]);
+        }
+    }
+#endif
+}
+
+MPM_NAMESPACE_END
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#endif
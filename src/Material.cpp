@@ -0,0 +1,94 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <mpm/Material.h>
+
+MPM_NAMESPACE_BEGIN
+
+Material::Material() : Material(glm::vec3(0), 0, 0, 0) {}
+Material::Material(
+    const glm::vec3 & velocity, float mass, float young, float poisson) {
+    this->velocity = velocity;
+    this->mass = mass;
+
+    float d = 1.0 / (1.0 + poisson);
+
+    lambda = young * poisson / (1.0 - 2.0 * poisson) * d;
+    mu = 0.5 * young * d;
+
+    plasticityModel = PlasticityModel::None;
+    relaxationTime = 0;
+    yieldStrain = 0;
+}
+
+Material & Material::setPlasticityModel(PlasticityModel plasticityModel) {
+    this->plasticityModel = plasticityModel;
+    return *this;
+}
+Material & Material::setRelaxationTime(float relaxationTime) {
+    this->relaxationTime = relaxationTime;
+    return *this;
+}
+Material & Material::setYieldStrain(float yieldStrain) {
+    this->yieldStrain = yieldStrain;
+    return *this;
+}
+
+const glm::vec3 & Material::getVelocity() const {
+    return velocity;
+}
+float Material::getMass() const {
+    return mass;
+}
+float Material::getLambda() const {
+    return lambda;
+}
+float Material::getMu() const {
+    return mu;
+}
+PlasticityModel Material::getPlasticityModel() const {
+    return plasticityModel;
+}
+float Material::getRelaxationTime() const {
+    return relaxationTime;
+}
+float Material::getYieldStrain() const {
+    return yieldStrain;
+}
+
+bool Material::operator==(const Material & material) const {
+    return velocity == material.velocity && mass == material.mass &&
+        lambda == material.lambda && mu == material.mu &&
+        plasticityModel == material.plasticityModel &&
+        relaxationTime == material.relaxationTime &&
+        yieldStrain == material.yieldStrain;
+}
+bool Material::operator!=(const Material & material) const {
+    return !(*this == material);
+}
+
+MPM_NAMESPACE_END
@@ -26,30 +26,186 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <mpm/MeshToParticle.h>
+#include <mpm/Random.h>
+#include <mpm/VolumeCache.h>
+#include <mpm/TriangleBvh.h>
 
 #include <openvdb/tools/MeshToVolume.h>
-#include <openvdb/tools/PointScatter.h>
+#include <openvdb/tools/LevelSetUtil.h>
+#include <openvdb/tree/LeafManager.h>
 
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+
+#include <algorithm>
+#include <cmath>
 #include <limits>
 
 MPM_NAMESPACE_BEGIN
 
-MeshDataAdapter::MeshDataAdapter(TriangleMesh * mesh, float voxelSize) {
-    this->mesh = mesh;
-    transform = openvdb::math::Transform::createLinearTransform(voxelSize);
+static const int TILE_CHUNK_SIZE = openvdb::FloatTree::LeafNodeType::DIM;
+
+static uint64_t getStream(const openvdb::Coord & origin) {
+    return (uint64_t)(origin.x() & 0x1fffff)
+        | (uint64_t)(origin.y() & 0x1fffff) << 21
+        | (uint64_t)(origin.z() & 0x1fffff) << 42;
+}
+static void scatterVoxel(
+    const openvdb::FloatGrid & grid, const openvdb::Coord & coordinate,
+    int pointCount, float fraction, float spread,
+    RandomGenerator & randomGenerator, std::vector<glm::vec3> & points) {
+    if (fraction > 0 && randomGenerator.generateUniform() < fraction)
+        pointCount++;
+
+    for (int i = 0; i < pointCount; i++) {
+        openvdb::Vec3d offset(
+            randomGenerator.generateUniform() - 0.5,
+            randomGenerator.generateUniform() - 0.5,
+            randomGenerator.generateUniform() - 0.5);
+        openvdb::Vec3d point = grid.indexToWorld(coordinate.asVec3d() + offset * spread);
+
+        points.push_back(glm::vec3(point.x(), point.y(), point.z()));
+    }
+}
+static openvdb::Coord factorStrata(double count, bool covering) {
+    int size = std::max((int)std::cbrt(count), 1);
+
+    while ((double)(size + 1) * (size + 1) * (size + 1) <= count)
+        size++;
+
+    // Growing one axis at a time by one keeps the strata close to cubes while
+    // stepping through the products between size^3 and (size + 1)^3.
+    openvdb::Coord strata(size);
+
+    for (int i = 0; i < 3; i++) {
+        double product = (double)strata.x() * strata.y() * strata.z();
+
+        if (covering ? product >= count : product * (size + 1) / size > count)
+            break;
+
+        strata[i]++;
+    }
+
+    return strata;
+}
+static void stratifyVoxel(
+    const openvdb::FloatGrid & grid, const openvdb::Coord & coordinate,
+    const openvdb::Coord & strata, float probability, float spread,
+    RandomGenerator & randomGenerator, std::vector<glm::vec3> & points) {
+    openvdb::Vec3d corner = coordinate.asVec3d() - openvdb::Vec3d(0.5);
+
+    for (int i = 0; i < strata.x(); i++) {
+        for (int j = 0; j < strata.y(); j++) {
+            for (int k = 0; k < strata.z(); k++) {
+                if (probability < 1.0f && randomGenerator.generateUniform() >= probability)
+                    continue;
+
+                openvdb::Vec3d offset(
+                    (i + 0.5 + spread * (randomGenerator.generateUniform() - 0.5)) / strata.x(),
+                    (j + 0.5 + spread * (randomGenerator.generateUniform() - 0.5)) / strata.y(),
+                    (k + 0.5 + spread * (randomGenerator.generateUniform() - 0.5)) / strata.z());
+                openvdb::Vec3d point = grid.indexToWorld(corner + offset);
+
+                points.push_back(glm::vec3(point.x(), point.y(), point.z()));
+            }
+        }
+    }
+}
+static void stratifyBlock(
+    const openvdb::FloatGrid & grid, const openvdb::Coord & coordinate,
+    const openvdb::Coord & blocks, float probability, float spread, size_t seed,
+    std::vector<glm::vec3> & points) {
+    openvdb::Coord block(
+        (int)std::floor((double)coordinate.x() / blocks.x()),
+        (int)std::floor((double)coordinate.y() / blocks.y()),
+        (int)std::floor((double)coordinate.z() / blocks.z()));
 
-    for (size_t i = 0; i < mesh->getVertexCount(); i++) {
-        glm::vec3 vertex = mesh->getVertex(i);
-        openvdb::Vec3d transformedPoint(vertex.x, vertex.y, vertex.z);
+    // Every voxel of a block draws the same candidate, and only the voxel it
+    // lands in emits it, so blocks spanning leaves and tiles are sampled once.
+    RandomGenerator randomGenerator(seed, getStream(block));
 
-        transformedPoint = transform->worldToIndex(transformedPoint);
+    if (randomGenerator.generateUniform() >= probability)
+        return;
 
-        vertex.x = transformedPoint.x();
-        vertex.y = transformedPoint.y();
-        vertex.z = transformedPoint.z();
+    openvdb::Vec3d position;
 
-        mesh->setVertex(i, vertex);
+    for (int i = 0; i < 3; i++) {
+        position[i] = (block[i] + 0.5 + spread * (randomGenerator.generateUniform() - 0.5))
+            * blocks[i] - 0.5;
+
+        if ((int)std::floor(position[i] + 0.5) != coordinate[i])
+            return;
+    }
+
+    openvdb::Vec3d point = grid.indexToWorld(position);
+
+    points.push_back(glm::vec3(point.x(), point.y(), point.z()));
+}
+
+static openvdb::FloatGrid::Ptr raycastVolume(const TriangleMesh * mesh, float voxelSize) {
+    openvdb::FloatGrid::Ptr grid = openvdb::FloatGrid::create(0.0f);
+    grid->setTransform(openvdb::math::Transform::createLinearTransform(voxelSize));
+
+    TriangleBvh bvh(*mesh);
+
+    if (bvh.empty())
+        return grid;
+
+    glm::vec3 lower, upper;
+    bvh.getBounds(lower, upper);
+
+    openvdb::Coord minimum(
+        (int)std::floor(lower.x / voxelSize),
+        (int)std::floor(lower.y / voxelSize),
+        (int)std::floor(lower.z / voxelSize));
+    openvdb::Coord maximum(
+        (int)std::ceil(upper.x / voxelSize),
+        (int)std::ceil(upper.y / voxelSize),
+        (int)std::ceil(upper.z / voxelSize));
+
+    size_t rowCount = (size_t)(maximum.y() - minimum.y() + 1);
+    size_t sliceCount = (size_t)(maximum.z() - minimum.z() + 1);
+    std::vector<std::vector<openvdb::CoordBBox>> spans(rowCount * sliceCount);
+
+    // Every row of voxel centers is classified with one ray along x, filling
+    // the voxels between alternate crossings.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, spans.size()),
+        [&](const tbb::blocked_range<size_t> & range) {
+        std::vector<float> distances;
+
+        for (size_t i = range.begin(); i < range.end(); i++) {
+            int y = minimum.y() + (int)(i % rowCount);
+            int z = minimum.z() + (int)(i / rowCount);
+            glm::vec3 origin((minimum.x() - 1) * voxelSize, y * voxelSize, z * voxelSize);
+
+            bvh.getIntersections(origin, glm::vec3(1.0f, 0.0f, 0.0f), distances);
+
+            for (size_t j = 0; j + 1 < distances.size(); j += 2) {
+                int first = (int)std::ceil((origin.x + distances[j]) / voxelSize);
+                int last = (int)std::floor((origin.x + distances[j + 1]) / voxelSize);
+
+                if (first <= last)
+                    spans[i].push_back(openvdb::CoordBBox(
+                        openvdb::Coord(first, y, z), openvdb::Coord(last, y, z)));
+            }
+        }
+    });
+
+    openvdb::FloatTree & tree = grid->tree();
+
+    for (const std::vector<openvdb::CoordBBox> & row : spans) {
+        for (const openvdb::CoordBBox & span : row)
+            tree.fill(span, 1.0f, true);
     }
+
+    tree.prune();
+
+    return grid;
+}
+
+MeshDataAdapter::MeshDataAdapter(const TriangleMesh * mesh, float voxelSize) {
+    this->mesh = mesh;
+    transform = openvdb::math::Transform::createLinearTransform(voxelSize);
 }
 
 size_t MeshDataAdapter::pointCount() const {
@@ -66,91 +222,184 @@ void MeshDataAdapter::getIndexSpacePoint(
     size_t polygonIndex, size_t vertexIndex, openvdb::math::Vec3d & position) const {
     const std::vector<size_t> & vertexIndices = mesh->getVertexIndices();
     size_t index = vertexIndices[polygonIndex * 3 + vertexIndex];
-    const glm::vec3 & vertex = mesh->getVertex(index);
+    glm::vec3 vertex = mesh->getTransformedVertex(index);
 
-    position[0] = vertex.x;
-    position[1] = vertex.y;
-    position[2] = vertex.z;
+    position = transform->worldToIndex(openvdb::Vec3d(vertex.x, vertex.y, vertex.z));
 }
 
-TriangleMesh * MeshDataAdapter::getMesh() {
+const TriangleMesh * MeshDataAdapter::getMesh() const {
     return mesh;
 }
 const openvdb::math::Transform & MeshDataAdapter::getTransform() const {
     return *transform.get();
 }
 
-Material::Material(
-    const glm::vec3 & velocity, float mass, float young, float poisson) {
-    this->velocity = velocity;
-    this->mass = mass;
+MeshToParticle::MeshToParticle(
+    const TriangleMesh * mesh, const Material & material,
+    float voxelSize, float density, float spread, size_t seed,
+    Sampling sampling, Voxelization voxelization, const VolumeCache * cache) {
+    float pointsPerVoxel = density * voxelSize;
+    int pointCount = (int)std::floor(pointsPerVoxel);
+    float fraction = pointsPerVoxel - pointCount;
 
-    float d = 1.0 / (1.0 + poisson);
+    // Stratified sampling splits each voxel into the fewest strata covering the
+    // requested count, or below one point per voxel groups voxels into the
+    // largest blocks holding at most one point, then thins the candidates so
+    // the expected count matches the density exactly.
+    openvdb::Coord strata(1);
+    openvdb::Coord blocks(1);
+    float probability = 0.0f;
 
-    lambda = young * poisson / (1.0 - 2.0 * poisson) * d;
-    mu = 0.5 * young * d;
-}
+    if (pointsPerVoxel >= 1.0f) {
+        strata = factorStrata(pointsPerVoxel, true);
+        probability = pointsPerVoxel / ((float)strata.x() * strata.y() * strata.z());
+    } else if (pointsPerVoxel > 0.0f) {
+        blocks = factorStrata(1.0 / pointsPerVoxel, false);
+        probability = pointsPerVoxel * ((float)blocks.x() * blocks.y() * blocks.z());
+    }
 
-const glm::vec3 & Material::getVelocity() const {
-    return velocity;
-}
-float Material::getMass() const {
-    return mass;
-}
-float Material::getLambda() const {
-    return lambda;
-}
-float Material::getMu() const {
-    return mu;
-}
+    float volume = voxelSize * voxelSize * voxelSize / pointsPerVoxel;
 
-Particle::Particle() {}
-Particle::Particle(const Material & material) {
-    apply(material);
-}
-Particle & Particle::apply(const Material & material) {
-    velocity = material.getVelocity();
-    mass = material.getMass();
-    lambda = material.getLambda();
-    mu = material.getMu();
+    uint64_t volumeKey = 0;
+    uint64_t pointKey = 0;
 
-    return *this;
-}
+    if (cache) {
+        volumeKey = VolumeCache::computeHash(*mesh);
+        volumeKey = VolumeCache::computeHash(&voxelSize, sizeof(voxelSize), volumeKey);
+        volumeKey = VolumeCache::computeHash(&voxelization, sizeof(voxelization), volumeKey);
 
-MeshToParticle::MeshToParticle(
-    TriangleMesh * mesh, const Material & material,
-    float voxelSize, float density, float spread, size_t seed) {
-    MeshDataAdapter meshDataAdapter(mesh, voxelSize);
+        uint64_t seedValue = seed;
 
-    openvdb::FloatGrid::Ptr grid = openvdb::tools::meshToVolume<openvdb::FloatGrid>
-        (meshDataAdapter, meshDataAdapter.getTransform(), 1.0, std::numeric_limits<float>::max());
+        pointKey = VolumeCache::computeHash(&density, sizeof(density), volumeKey);
+        pointKey = VolumeCache::computeHash(&spread, sizeof(spread), pointKey);
+        pointKey = VolumeCache::computeHash(&seedValue, sizeof(seedValue), pointKey);
+        pointKey = VolumeCache::computeHash(&sampling, sizeof(sampling), pointKey);
 
-    RandomGenerator randomGenerator(seed);
+        std::vector<glm::vec3> points;
+        float cachedVolume;
 
-    openvdb::tools::DenseUniformPointScatter<MeshToParticle, RandomGenerator>
-        denseUniformPointScatter(*this, density * voxelSize, randomGenerator, spread);
+        if (cache->loadPoints(pointKey, points, cachedVolume)) {
+            particles.append(points.data(), points.size(), material, cachedVolume);
+            return;
+        }
+    }
 
-    denseUniformPointScatter(*grid.get());
-}
-MeshToParticle::~MeshToParticle() {
-    for (Particle * particle : particles) {
-        if (particle)
-            delete particle;
+    openvdb::FloatGrid::Ptr grid = cache ? cache->loadVolume(volumeKey) : nullptr;
+
+    if (!grid && voxelization == Voxelization::Raycast) {
+        grid = raycastVolume(mesh, voxelSize);
+
+        if (cache)
+            cache->saveVolume(volumeKey, grid);
     }
-}
 
-ParticlePointerArray & MeshToParticle::getParticles() {
-    return particles;
-}
+    if (!grid) {
+        MeshDataAdapter meshDataAdapter(mesh, voxelSize);
+
+        float interiorBandWidth = voxelization == Voxelization::Sparse ?
+            1.0f : std::numeric_limits<float>::max();
 
-void MeshToParticle::add(const openvdb::Vec3d & point) {
-    Particle * particle = new Particle();
+        grid = openvdb::tools::meshToVolume<openvdb::FloatGrid>
+            (meshDataAdapter, meshDataAdapter.getTransform(), 1.0, interiorBandWidth);
 
-    particle->position.x = point.x();
-    particle->position.y = point.y();
-    particle->position.z = point.z();
+        if (voxelization == Voxelization::Sparse)
+            openvdb::tools::sdfToFogVolume(*grid);
+
+        if (cache)
+            cache->saveVolume(volumeKey, grid);
+    }
 
-    particles.push_back(particle);
+    auto scatter = [&](const openvdb::Coord & coordinate,
+        RandomGenerator & randomGenerator, std::vector<glm::vec3> & points) {
+        if (sampling == Sampling::Stratified && pointsPerVoxel < 1.0f)
+            stratifyBlock(*grid, coordinate, blocks, probability, spread, seed, points);
+        else if (sampling == Sampling::Stratified)
+            stratifyVoxel(*grid, coordinate, strata, probability, spread, randomGenerator, points);
+        else
+            scatterVoxel(*grid, coordinate, pointCount, fraction, spread, randomGenerator, points);
+    };
+
+    const openvdb::FloatTree & tree = grid->tree();
+    openvdb::tree::LeafManager<const openvdb::FloatTree> leafManager(tree);
+
+    std::vector<openvdb::CoordBBox> tiles;
+    openvdb::FloatTree::ValueOnCIter iterator = tree.cbeginValueOn();
+    iterator.setMaxDepth(openvdb::FloatTree::ValueOnCIter::LEAF_DEPTH - 1);
+
+    for (; iterator; ++iterator) {
+        openvdb::CoordBBox bounds;
+        iterator.getBoundingBox(bounds);
+
+        for (int x = bounds.min().x(); x <= bounds.max().x(); x += TILE_CHUNK_SIZE) {
+            for (int y = bounds.min().y(); y <= bounds.max().y(); y += TILE_CHUNK_SIZE) {
+                for (int z = bounds.min().z(); z <= bounds.max().z(); z += TILE_CHUNK_SIZE) {
+                    openvdb::Coord origin(x, y, z);
+                    openvdb::Coord extent = origin + openvdb::Coord(TILE_CHUNK_SIZE - 1);
+
+                    tiles.push_back(openvdb::CoordBBox(origin, openvdb::Coord(
+                        std::min(extent.x(), bounds.max().x()),
+                        std::min(extent.y(), bounds.max().y()),
+                        std::min(extent.z(), bounds.max().z()))));
+                }
+            }
+        }
+    }
+
+    size_t leafCount = leafManager.leafCount();
+    std::vector<std::vector<glm::vec3>> regions(leafCount + tiles.size());
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, regions.size()),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t i = range.begin(); i < range.end(); i++) {
+            if (i < leafCount) {
+                const openvdb::FloatTree::LeafNodeType & leaf = leafManager.leaf(i);
+                RandomGenerator randomGenerator(seed, getStream(leaf.origin()));
+
+                for (openvdb::FloatTree::LeafNodeType::ValueOnCIter voxel = leaf.cbeginValueOn();
+                    voxel; ++voxel) {
+                    scatter(voxel.getCoord(), randomGenerator, regions[i]);
+                }
+
+                continue;
+            }
+
+            const openvdb::CoordBBox & bounds = tiles[i - leafCount];
+            RandomGenerator randomGenerator(seed, getStream(bounds.min()));
+
+            for (int x = bounds.min().x(); x <= bounds.max().x(); x++) {
+                for (int y = bounds.min().y(); y <= bounds.max().y(); y++) {
+                    for (int z = bounds.min().z(); z <= bounds.max().z(); z++) {
+                        scatter(openvdb::Coord(x, y, z), randomGenerator, regions[i]);
+                    }
+                }
+            }
+        }
+    });
+
+    std::vector<size_t> offsets(regions.size() + 1, 0);
+
+    for (size_t i = 0; i < regions.size(); i++)
+        offsets[i + 1] = offsets[i] + regions[i].size();
+
+    std::vector<glm::vec3> points(offsets.back());
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, regions.size()),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t i = range.begin(); i < range.end(); i++) {
+            std::copy(regions[i].begin(), regions[i].end(), points.begin() + offsets[i]);
+            std::vector<glm::vec3>().swap(regions[i]);
+        }
+    });
+
+    if (cache)
+        cache->savePoints(pointKey, points, volume);
+
+    particles.append(points.data(), points.size(), material, volume);
+}
+MeshToParticle::~MeshToParticle() {}
+
+ParticleSystem & MeshToParticle::getParticles() {
+    return particles;
 }
 
 MPM_NAMESPACE_END
\ No newline at end of file
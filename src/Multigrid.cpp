@@ -0,0 +1,526 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <mpm/Multigrid.h>
+
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+
+#include <algorithm>
+#include <cmath>
+
+MPM_NAMESPACE_BEGIN
+
+static const float JACOBI_WEIGHT = 2.0f / 3.0f;
+static const size_t COARSEST_BLOCK_COUNT = 8;
+static const size_t COARSEST_SMOOTHING_STEPS = 16;
+static const size_t MAXIMUM_FACTOR_SIZE = 1024;
+
+static int64_t findNeighbor(const Grid & grid,
+    const std::vector<int32_t> & neighbors, size_t b, const glm::ivec3 & local, int direction) {
+    int axis = direction >> 1;
+    int size = grid.getBlockSize()[axis];
+
+    glm::ivec3 node = local;
+    node[axis] += direction & 1 ? 1 : -1;
+
+    int64_t block = (int64_t)b;
+
+    if (node[axis] < 0 || node[axis] >= size) {
+        block = neighbors[6 * b + direction];
+        node[axis] &= size - 1;
+    }
+
+    if (block < 0)
+        return -1;
+
+    return block * Grid::BLOCK_VOLUME + (int64_t)grid.getNodeIndex(node);
+}
+
+template <int dimension, typename T>
+static void restrictField(
+    const Grid & fine, const std::vector<T> & source, const Grid & coarse, std::vector<T> & target) {
+    typedef Grid::Layout<dimension> Layout;
+
+    const int reach = dimension == 3 ? 1 : 0;
+
+    glm::ivec3 size = Layout::getBlockSize();
+    glm::ivec3 ratio = Layout::getCoarseningRatio();
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, coarse.getBlockCount()),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t c = range.begin(); c < range.end(); c++) {
+            const Grid::Block & block = coarse.getBlock(c);
+
+            glm::ivec3 origin = Layout::getBlockCoordinate(
+                ratio * block.coordinate * size - ratio + 1);
+            const Grid::Block * fineBlocks[27];
+
+            for (int i = 0; i < 27; i++) {
+                fineBlocks[i] = i % 3 <= 2 * reach
+                    ? fine.findBlock(origin + glm::ivec3(i / 9, (i / 3) % 3, i % 3)) : nullptr;
+            }
+
+            for (size_t n = 0; n < Grid::BLOCK_VOLUME; n++) {
+                glm::ivec3 base = ratio * (block.coordinate * size
+                    + Layout::getNodeCoordinate(n)) - origin * size;
+
+                T value(0);
+
+                for (int i = -1; i <= 1; i++) {
+                    for (int j = -1; j <= 1; j++) {
+                        for (int k = -reach; k <= reach; k++) {
+                            glm::ivec3 node = base + glm::ivec3(i, j, k);
+                            glm::ivec3 offset = node / size;
+
+                            const Grid::Block * fineBlock =
+                                fineBlocks[(offset.x * 3 + offset.y) * 3 + offset.z];
+
+                            if (!fineBlock)
+                                continue;
+
+                            float weight = (i ? 0.5f : 1.0f) * (j ? 0.5f : 1.0f) * (k ? 0.5f : 1.0f);
+                            size_t index = fineBlock->index * Grid::BLOCK_VOLUME
+                                + Grid::Neighborhood::getNode<dimension>(node.x, node.y, node.z);
+
+                            value += weight * source[index];
+                        }
+                    }
+                }
+
+                target[c * Grid::BLOCK_VOLUME + n] = value;
+            }
+        }
+    });
+}
+template <int dimension, typename T>
+static void prolongateField(
+    const Grid & coarse, const std::vector<T> & source, const Grid & fine,
+    const std::vector<float> & masses, std::vector<T> & target) {
+    typedef Grid::Layout<dimension> Layout;
+
+    glm::ivec3 size = Layout::getBlockSize();
+    glm::ivec3 ratio = Layout::getCoarseningRatio();
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, fine.getBlockCount()),
+        [&](const tbb::blocked_range<size_t> & range) {
+        Grid::Neighborhood neighborhood;
+
+        for (size_t b = range.begin(); b < range.end(); b++) {
+            const Grid::Block & block = fine.getBlock(b);
+
+            glm::ivec3 origin = Layout::getBlockCoordinate(block.coordinate * size / ratio);
+            neighborhood.fetch(coarse, origin);
+
+            for (size_t n = 0; n < Grid::BLOCK_VOLUME; n++) {
+                size_t index = b * Grid::BLOCK_VOLUME + n;
+
+                if (masses[index] <= 0)
+                    continue;
+
+                glm::ivec3 node = block.coordinate * size + Layout::getNodeCoordinate(n);
+                glm::ivec3 odd(node.x & 1, node.y & 1, node.z & (ratio.z - 1));
+                glm::ivec3 lower = (node - odd) / ratio - origin * size;
+
+                T value(0);
+
+                for (int corner = 0; corner < 8; corner++) {
+                    glm::ivec3 offset(corner >> 2, (corner >> 1) & 1, corner & 1);
+
+                    if (offset.x > odd.x || offset.y > odd.y || offset.z > odd.z)
+                        continue;
+
+                    glm::ivec3 coarseNode = lower + offset;
+                    const Grid::Block * coarseBlock =
+                        neighborhood.getBlock<dimension>(coarseNode.x, coarseNode.y, coarseNode.z);
+
+                    if (!coarseBlock)
+                        continue;
+
+                    float weight = (odd.x ? 0.5f : 1.0f) * (odd.y ? 0.5f : 1.0f) * (odd.z ? 0.5f : 1.0f);
+
+                    value += weight * source[coarseBlock->index * Grid::BLOCK_VOLUME
+                        + Grid::Neighborhood::getNode<dimension>(coarseNode.x, coarseNode.y, coarseNode.z)];
+                }
+
+                target[index] += value;
+            }
+        }
+    });
+}
+template <typename T>
+static void restrictField(
+    const Grid & fine, const std::vector<T> & source, const Grid & coarse, std::vector<T> & target) {
+    if (fine.getDimension() == 2)
+        restrictField<2>(fine, source, coarse, target);
+    else
+        restrictField<3>(fine, source, coarse, target);
+}
+template <typename T>
+static void prolongateField(
+    const Grid & coarse, const std::vector<T> & source, const Grid & fine,
+    const std::vector<float> & masses, std::vector<T> & target) {
+    if (fine.getDimension() == 2)
+        prolongateField<2>(coarse, source, fine, masses, target);
+    else
+        prolongateField<3>(coarse, source, fine, masses, target);
+}
+
+Multigrid & Multigrid::connect(Level & level) {
+    const Grid & grid = *level.grid;
+    size_t blockCount = grid.getBlockCount();
+    size_t nodeCount = grid.getNodeCount();
+
+    level.neighbors.resize(6 * blockCount);
+    level.diagonals.resize(nodeCount);
+    level.solutions.resize(nodeCount);
+    level.rightHandSides.resize(nodeCount);
+    level.residuals.resize(nodeCount);
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, blockCount),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t b = range.begin(); b < range.end(); b++) {
+            const Grid::Block & block = grid.getBlock(b);
+
+            for (int direction = 0; direction < 6; direction++) {
+                glm::ivec3 coordinate = block.coordinate;
+                coordinate[direction >> 1] += direction & 1 ? 1 : -1;
+
+                const Grid::Block * neighbor = grid.findBlock(coordinate);
+                level.neighbors[6 * b + direction] = neighbor ? (int32_t)neighbor->index : -1;
+            }
+        }
+    });
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, blockCount),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t b = range.begin(); b < range.end(); b++) {
+            for (size_t n = 0; n < Grid::BLOCK_VOLUME; n++) {
+                size_t index = b * Grid::BLOCK_VOLUME + n;
+                float mass = level.masses[index];
+                float diagonal = mass;
+
+                for (int direction = 0; mass > 0 && direction < 6; direction++) {
+                    int64_t neighbor = findNeighbor(grid,
+                        level.neighbors, b, grid.getNodeCoordinate(n), direction);
+
+                    if (neighbor >= 0 && level.masses[neighbor] > 0)
+                        diagonal += level.coupling * (mass + level.masses[neighbor]);
+                }
+
+                level.diagonals[index] = mass > 0 ? diagonal : 0.0f;
+            }
+        }
+    });
+
+    return *this;
+}
+Multigrid & Multigrid::factorize() {
+    const Level & level = *levels[levelCount - 1];
+
+    coarseNodes.clear();
+    coarseFactor.clear();
+
+    for (size_t i = 0; i < level.masses.size(); i++) {
+        if (level.masses[i] > 0)
+            coarseNodes.push_back((uint32_t)i);
+    }
+
+    size_t size = coarseNodes.size();
+
+    if (size > MAXIMUM_FACTOR_SIZE || (levelCount == 1 && !constraints.empty())) {
+        coarseNodes.clear();
+        return *this;
+    }
+
+    std::vector<int32_t> slots(level.masses.size(), -1);
+
+    for (size_t i = 0; i < size; i++)
+        slots[coarseNodes[i]] = (int32_t)i;
+
+    coarseFactor.assign(size * size, 0.0);
+    coarseValues.resize(size);
+
+    for (size_t i = 0; i < size; i++) {
+        size_t index = coarseNodes[i];
+        size_t b = index / Grid::BLOCK_VOLUME;
+
+        coarseFactor[i * size + i] = level.diagonals[index];
+
+        for (int direction = 0; direction < 6; direction++) {
+            int64_t neighbor = findNeighbor(*level.grid, level.neighbors, b,
+                level.grid->getNodeCoordinate(index % Grid::BLOCK_VOLUME), direction);
+
+            if (neighbor >= 0 && slots[neighbor] >= 0) {
+                coarseFactor[i * size + slots[neighbor]] =
+                    -level.coupling * (level.masses[index] + level.masses[neighbor]);
+            }
+        }
+    }
+
+    for (size_t j = 0; j < size; j++) {
+        double * row = &coarseFactor[j * size];
+        double diagonal = row[j];
+
+        for (size_t k = 0; k < j; k++)
+            diagonal -= row[k] * row[k];
+
+        diagonal = std::sqrt(std::max(diagonal, 1.0e-30));
+        row[j] = diagonal;
+
+        tbb::parallel_for(tbb::blocked_range<size_t>(j + 1, size),
+            [&](const tbb::blocked_range<size_t> & range) {
+            for (size_t i = range.begin(); i < range.end(); i++) {
+                double * other = &coarseFactor[i * size];
+                double value = other[j];
+
+                for (size_t k = 0; k < j; k++)
+                    value -= other[k] * row[k];
+
+                other[j] = value / diagonal;
+            }
+        });
+    }
+
+    return *this;
+}
+Multigrid & Multigrid::solveCoarsest() {
+    Level & level = *levels[levelCount - 1];
+    size_t size = coarseNodes.size();
+
+    if (size == 0)
+        return smooth(levelCount - 1, COARSEST_SMOOTHING_STEPS);
+
+    for (int axis = 0; axis < 3; axis++) {
+        for (size_t i = 0; i < size; i++) {
+            const double * row = &coarseFactor[i * size];
+            double value = level.rightHandSides[coarseNodes[i]][axis];
+
+            for (size_t k = 0; k < i; k++)
+                value -= row[k] * coarseValues[k];
+
+            coarseValues[i] = value / row[i];
+        }
+
+        for (size_t i = size; i-- > 0;) {
+            double value = coarseValues[i];
+
+            for (size_t k = i + 1; k < size; k++)
+                value -= coarseFactor[k * size + i] * coarseValues[k];
+
+            coarseValues[i] = value / coarseFactor[i * size + i];
+        }
+
+        for (size_t i = 0; i < size; i++)
+            level.solutions[coarseNodes[i]][axis] = (float)coarseValues[i];
+    }
+
+    return *this;
+}
+Multigrid & Multigrid::computeResiduals(size_t l) {
+    Level & level = *levels[l];
+    const Grid & grid = *level.grid;
+    bool constrained = l == 0 && !constraints.empty();
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, grid.getBlockCount()),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t b = range.begin(); b < range.end(); b++) {
+            for (size_t n = 0; n < Grid::BLOCK_VOLUME; n++) {
+                size_t index = b * Grid::BLOCK_VOLUME + n;
+                float mass = level.masses[index];
+
+                if (mass <= 0) {
+                    level.residuals[index] = glm::vec3(0);
+                    continue;
+                }
+
+                glm::vec3 solution = level.solutions[index];
+                glm::vec3 product = mass * solution;
+
+                for (int direction = 0; direction < 6; direction++) {
+                    int64_t neighbor = findNeighbor(grid,
+                        level.neighbors, b, grid.getNodeCoordinate(n), direction);
+
+                    if (neighbor < 0 || level.masses[neighbor] <= 0)
+                        continue;
+
+                    product += level.coupling * (mass + level.masses[neighbor])
+                        * (solution - level.solutions[neighbor]);
+                }
+
+                glm::vec3 residual = level.rightHandSides[index] - product;
+
+                for (int axis = 0; constrained && axis < 3; axis++) {
+                    if (constraints[index] & (1 << axis))
+                        residual[axis] = 0;
+                }
+
+                level.residuals[index] = residual;
+            }
+        }
+    });
+
+    return *this;
+}
+Multigrid & Multigrid::smooth(size_t l, size_t steps) {
+    Level & level = *levels[l];
+
+    for (size_t step = 0; step < steps; step++) {
+        computeResiduals(l);
+
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, level.solutions.size()),
+            [&](const tbb::blocked_range<size_t> & range) {
+            for (size_t i = range.begin(); i < range.end(); i++) {
+                float diagonal = level.diagonals[i];
+
+                if (diagonal > 0)
+                    level.solutions[i] += JACOBI_WEIGHT / diagonal * level.residuals[i];
+            }
+        });
+    }
+
+    return *this;
+}
+Multigrid & Multigrid::restrictResiduals(size_t l) {
+    const Level & fine = *levels[l];
+    Level & coarse = *levels[l + 1];
+
+    restrictField(*fine.grid, fine.residuals, *coarse.grid, coarse.rightHandSides);
+
+    return *this;
+}
+Multigrid & Multigrid::prolongateSolutions(size_t l) {
+    Level & fine = *levels[l];
+    const Level & coarse = *levels[l + 1];
+
+    prolongateField(*coarse.grid, coarse.solutions, *fine.grid, fine.masses, fine.solutions);
+
+    if (l != 0 || constraints.empty())
+        return *this;
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, fine.solutions.size()),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t i = range.begin(); i < range.end(); i++) {
+            for (int axis = 0; axis < 3; axis++) {
+                if (constraints[i] & (1 << axis))
+                    fine.solutions[i][axis] = 0;
+            }
+        }
+    });
+
+    return *this;
+}
+Multigrid & Multigrid::cycle(size_t l) {
+    Level & level = *levels[l];
+
+    std::fill(level.solutions.begin(), level.solutions.end(), glm::vec3(0));
+
+    if (l + 1 == levelCount)
+        return solveCoarsest();
+
+    smooth(l, smoothingSteps);
+    computeResiduals(l);
+    restrictResiduals(l);
+    cycle(l + 1);
+    prolongateSolutions(l);
+
+    return smooth(l, smoothingSteps);
+}
+
+Multigrid::Multigrid() : levelCount(0), maximumLevels(8), smoothingSteps(2) {}
+Multigrid::~Multigrid() {}
+
+Multigrid & Multigrid::build(
+    const Grid & grid, Span<const float> masses, Span<const uint8_t> constraints, float stiffness) {
+    this->constraints = constraints;
+    levelCount = 0;
+
+    while (levelCount < std::max(maximumLevels, (size_t)1)) {
+        if (levels.size() == levelCount)
+            levels.emplace_back(new Level());
+
+        Level & level = *levels[levelCount];
+
+        if (levelCount == 0) {
+            level.grid = &grid;
+            level.masses.assign(masses.begin(), masses.end());
+        }
+        else {
+            const Level & fine = *levels[levelCount - 1];
+
+            level.coarseGrid.coarsen(*fine.grid,
+                Span<const float>(fine.masses.data(), fine.masses.size()));
+            level.grid = &level.coarseGrid;
+            level.masses.resize(level.coarseGrid.getNodeCount());
+
+            restrictField(*fine.grid, fine.masses, level.coarseGrid, level.masses);
+        }
+
+        float spacing = level.grid->getSpacing();
+        level.coupling = stiffness / (2.0f * spacing * spacing);
+
+        connect(level);
+        levelCount++;
+
+        if (level.grid->getBlockCount() <= COARSEST_BLOCK_COUNT)
+            break;
+    }
+
+    return factorize();
+}
+Multigrid & Multigrid::apply(Span<const glm::vec3> residuals, Span<glm::vec3> results) {
+    if (levelCount == 0)
+        return *this;
+
+    Level & level = *levels[0];
+
+    std::copy(residuals.begin(), residuals.end(), level.rightHandSides.begin());
+    cycle(0);
+    std::copy(level.solutions.begin(), level.solutions.end(), results.begin());
+
+    return *this;
+}
+
+Multigrid & Multigrid::setMaximumLevels(size_t maximumLevels) {
+    this->maximumLevels = maximumLevels;
+    return *this;
+}
+Multigrid & Multigrid::setSmoothingSteps(size_t smoothingSteps) {
+    this->smoothingSteps = smoothingSteps;
+    return *this;
+}
+
+size_t Multigrid::getMaximumLevels() const {
+    return maximumLevels;
+}
+size_t Multigrid::getSmoothingSteps() const {
+    return smoothingSteps;
+}
+size_t Multigrid::getLevelCount() const {
+    return levelCount;
+}
+
+MPM_NAMESPACE_END
@@ -0,0 +1,312 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <mpm/ParticleSorter.h>
+#include <mpm/Grid.h>
+
+#include <glm/common.hpp>
+
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/parallel_sort.h>
+#include <tbb/blocked_range.h>
+#include <tbb/task_arena.h>
+
+#include <algorithm>
+#include <functional>
+
+MPM_NAMESPACE_BEGIN
+
+static const int RADIX_BITS = 8;
+static const size_t RADIX_SIZE = 1 << RADIX_BITS;
+static const size_t RADIX_GRAIN = 1 << 16;
+static const size_t REPAIR_DIVISOR = 64;
+static const int REPAIR_PASSES = 4;
+
+static uint64_t spreadBits(uint64_t x) {
+    x &= 0x1fffff;
+    x = (x | (x << 32)) & 0x1f00000000ffffull;
+    x = (x | (x << 16)) & 0x1f0000ff0000ffull;
+    x = (x | (x << 8)) & 0x100f00f00f00f00full;
+    x = (x | (x << 4)) & 0x10c30c30c30c30c3ull;
+    x = (x | (x << 2)) & 0x1249249249249249ull;
+
+    return x;
+}
+
+static size_t getChunkCount(size_t count) {
+    return std::min(std::max<size_t>(count / RADIX_GRAIN, 1),
+        (size_t)tbb::this_task_arena::max_concurrency() * 4);
+}
+
+ParticleSorter & ParticleSorter::computeKeys(
+    Span<const glm::vec3> positions, float spacing, Interpolation interpolation, int dimension) {
+    float inverseSpacing = 1.0 / spacing;
+    float offset = Kernel::getStencilOffset(interpolation);
+
+    keys.resize(positions.size());
+    indices.resize(positions.size());
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, positions.size()),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t i = range.begin(); i < range.end(); i++) {
+            glm::ivec3 base = glm::ivec3(glm::floor(positions[i] * inverseSpacing - offset));
+
+            keys[i] = getMortonCode(dimension == 2 ? Grid::Layout<2>::getBlockCoordinate(base)
+                : Grid::Layout<3>::getBlockCoordinate(base));
+            indices[i] = (uint32_t)i;
+        }
+    });
+
+    return *this;
+}
+size_t ParticleSorter::countDescents() const {
+    return tbb::parallel_reduce(
+        tbb::blocked_range<size_t>(1, std::max<size_t>(keys.size(), 1)), (size_t)0,
+        [this](const tbb::blocked_range<size_t> & range, size_t descents) {
+        for (size_t i = range.begin(); i < range.end(); i++)
+            descents += keys[i - 1] > keys[i];
+
+        return descents;
+    }, std::plus<size_t>());
+}
+bool ParticleSorter::repair(size_t limit) {
+    size_t count = keys.size();
+    size_t chunkCount = getChunkCount(count);
+    std::vector<size_t> keptOffsets(chunkCount + 1);
+    std::vector<size_t> displacedOffsets(chunkCount + 1);
+
+    keptIndices.resize(count);
+    displacedIndices.clear();
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, count),
+        [this](const tbb::blocked_range<size_t> & range) {
+        std::copy(indices.begin() + range.begin(), indices.begin() + range.end(),
+            keptIndices.begin() + range.begin());
+    });
+
+    auto isDisplaced = [this](size_t i, size_t size) {
+        return (i > 0 && keys[keptIndices[i - 1]] > keys[keptIndices[i]])
+            || (i + 1 < size && keys[keptIndices[i]] > keys[keptIndices[i + 1]]);
+    };
+
+    // Both ends of every descent are pulled out until the remaining keys are
+    // in order; each pass counts and compacts per chunk behind a prefix sum.
+    for (int pass = 0; ; pass++) {
+        size_t size = keptIndices.size();
+        size_t chunkSize = (size + chunkCount - 1) / chunkCount;
+
+        tbb::parallel_for((size_t)0, chunkCount, [&](size_t chunk) {
+            size_t end = std::min(size, (chunk + 1) * chunkSize);
+            size_t displaced = 0;
+
+            for (size_t i = chunk * chunkSize; i < end; i++)
+                displaced += isDisplaced(i, size);
+
+            displacedOffsets[chunk + 1] = displaced;
+            keptOffsets[chunk + 1] = end > chunk * chunkSize ? end - chunk * chunkSize - displaced : 0;
+        });
+
+        for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+            keptOffsets[chunk + 1] += keptOffsets[chunk];
+            displacedOffsets[chunk + 1] += displacedOffsets[chunk];
+        }
+
+        if (displacedOffsets[chunkCount] == 0)
+            break;
+
+        size_t base = displacedIndices.size();
+
+        if (pass == REPAIR_PASSES || base + displacedOffsets[chunkCount] > limit)
+            return false;
+
+        nextIndices.resize(keptOffsets[chunkCount]);
+        displacedIndices.resize(base + displacedOffsets[chunkCount]);
+
+        tbb::parallel_for((size_t)0, chunkCount, [&](size_t chunk) {
+            size_t end = std::min(size, (chunk + 1) * chunkSize);
+            size_t kept = keptOffsets[chunk];
+            size_t displaced = base + displacedOffsets[chunk];
+
+            for (size_t i = chunk * chunkSize; i < end; i++) {
+                if (isDisplaced(i, size))
+                    displacedIndices[displaced++] = keptIndices[i];
+                else
+                    nextIndices[kept++] = keptIndices[i];
+            }
+        });
+
+        keptIndices.swap(nextIndices);
+    }
+
+    tbb::parallel_sort(displacedIndices.begin(), displacedIndices.end(),
+        [this](uint32_t a, uint32_t b) {
+        return keys[a] < keys[b] || (keys[a] == keys[b] && a < b);
+    });
+
+    size_t keptCount = keptIndices.size();
+    size_t displacedCount = displacedIndices.size();
+    size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+
+    swapKeys.resize(count);
+    swapIndices.resize(count);
+
+    // Each chunk of the output finds its starting split along the merge path
+    // and merges independently; kept keys win ties.
+    tbb::parallel_for((size_t)0, chunkCount, [&](size_t chunk) {
+        size_t first = std::min(count, chunk * chunkSize);
+        size_t end = std::min(count, first + chunkSize);
+        size_t lower = first > displacedCount ? first - displacedCount : 0;
+        size_t upper = std::min(first, keptCount);
+
+        while (lower < upper) {
+            size_t middle = (lower + upper) / 2;
+
+            if (keys[keptIndices[middle]] <= keys[displacedIndices[first - middle - 1]])
+                lower = middle + 1;
+            else
+                upper = middle;
+        }
+
+        size_t i = lower;
+        size_t j = first - lower;
+
+        for (size_t k = first; k < end; k++) {
+            uint32_t index = j == displacedCount || (i < keptCount
+                && keys[keptIndices[i]] <= keys[displacedIndices[j]]) ?
+                keptIndices[i++] : displacedIndices[j++];
+
+            swapKeys[k] = keys[index];
+            swapIndices[k] = index;
+        }
+    });
+
+    keys.swap(swapKeys);
+    indices.swap(swapIndices);
+
+    return true;
+}
+ParticleSorter & ParticleSorter::radixSort() {
+    size_t count = keys.size();
+
+    uint64_t varying = tbb::parallel_reduce(
+        tbb::blocked_range<size_t>(0, count), (uint64_t)0,
+        [this](const tbb::blocked_range<size_t> & range, uint64_t bits) {
+        for (size_t i = range.begin(); i < range.end(); i++)
+            bits |= keys[i] ^ keys[0];
+
+        return bits;
+    }, std::bit_or<uint64_t>());
+
+    size_t chunkCount = getChunkCount(count);
+    size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+
+    std::vector<size_t> offsets(chunkCount * RADIX_SIZE);
+
+    swapKeys.resize(count);
+    swapIndices.resize(count);
+
+    for (int shift = 0; shift < 64 && (varying >> shift); shift += RADIX_BITS) {
+        if (((varying >> shift) & (RADIX_SIZE - 1)) == 0)
+            continue;
+
+        tbb::parallel_for((size_t)0, chunkCount, [&](size_t chunk) {
+            size_t * histogram = &offsets[chunk * RADIX_SIZE];
+            size_t end = std::min(count, (chunk + 1) * chunkSize);
+
+            std::fill(histogram, histogram + RADIX_SIZE, 0);
+
+            for (size_t i = chunk * chunkSize; i < end; i++)
+                histogram[(keys[i] >> shift) & (RADIX_SIZE - 1)]++;
+        });
+
+        size_t sum = 0;
+
+        for (size_t digit = 0; digit < RADIX_SIZE; digit++) {
+            for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+                size_t & offset = offsets[chunk * RADIX_SIZE + digit];
+                size_t value = offset;
+
+                offset = sum;
+                sum += value;
+            }
+        }
+
+        tbb::parallel_for((size_t)0, chunkCount, [&](size_t chunk) {
+            size_t * offset = &offsets[chunk * RADIX_SIZE];
+            size_t end = std::min(count, (chunk + 1) * chunkSize);
+
+            for (size_t i = chunk * chunkSize; i < end; i++) {
+                size_t position = offset[(keys[i] >> shift) & (RADIX_SIZE - 1)]++;
+
+                swapKeys[position] = keys[i];
+                swapIndices[position] = indices[i];
+            }
+        });
+
+        keys.swap(swapKeys);
+        indices.swap(swapIndices);
+    }
+
+    return *this;
+}
+
+ParticleSorter::ParticleSorter() {}
+ParticleSorter::~ParticleSorter() {}
+
+bool ParticleSorter::sort(
+    ParticleSystem & particles, float spacing, Interpolation interpolation, int dimension) {
+    computeKeys(particles.getPositions(), spacing, interpolation, dimension);
+
+    size_t descents = countDescents();
+
+    if (descents == 0)
+        return false;
+
+    size_t limit = keys.size() / REPAIR_DIVISOR;
+
+    if (descents > limit || !repair(limit))
+        radixSort();
+
+    particles.permute(Span<const uint32_t>(indices.data(), indices.size()));
+
+    return true;
+}
+
+Span<const uint64_t> ParticleSorter::getKeys() const {
+    return Span<const uint64_t>(keys.data(), keys.size());
+}
+
+uint64_t ParticleSorter::getMortonCode(const glm::ivec3 & coordinate) {
+    static const int bias = 1 << 20;
+
+    return spreadBits(coordinate.x + bias)
+        | (spreadBits(coordinate.y + bias) << 1)
+        | (spreadBits(coordinate.z + bias) << 2);
+}
+
+MPM_NAMESPACE_END
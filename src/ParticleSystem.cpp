@@ -0,0 +1,239 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <mpm/ParticleSystem.h>
+
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+
+#include <algorithm>
+#include <limits>
+
+MPM_NAMESPACE_BEGIN
+
+template <typename T>
+static Span<T> makeSpan(AlignedArray<T> & array) {
+    return Span<T>(array.data(), array.size());
+}
+template <typename T>
+static Span<const T> makeSpan(const AlignedArray<T> & array) {
+    return Span<const T>(array.data(), array.size());
+}
+
+template <typename T>
+static void permuteArray(AlignedArray<T> & array, Span<const uint32_t> order) {
+    AlignedArray<T> permuted(array.size());
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, order.size()),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t i = range.begin(); i < range.end(); i++)
+            permuted[i] = array[order[i]];
+    });
+
+    array.swap(permuted);
+}
+
+ParticleSystem::ParticleSystem() {}
+ParticleSystem::~ParticleSystem() {}
+
+ParticleSystem & ParticleSystem::reserve(size_t count) {
+    positions.reserve(count);
+    velocities.reserve(count);
+    volumes.reserve(count);
+    affines.reserve(count);
+    deformationGradients.reserve(count);
+    materials.reserve(count);
+
+    return *this;
+}
+ParticleSystem & ParticleSystem::resize(size_t count) {
+    positions.resize(count);
+    velocities.resize(count);
+    volumes.resize(count);
+    affines.resize(count, glm::mat3(0));
+    deformationGradients.resize(count, glm::mat3(1.0));
+    materials.resize(count);
+
+    if (count > 0 && materialTable.empty())
+        materialTable.resize(1);
+
+    return *this;
+}
+ParticleSystem & ParticleSystem::clear() {
+    positions.clear();
+    velocities.clear();
+    volumes.clear();
+    affines.clear();
+    deformationGradients.clear();
+    materials.clear();
+    materialTable.clear();
+
+    return *this;
+}
+
+bool ParticleSystem::append(const ParticleSystem & particles) {
+    size_t offset = getParticleCount();
+    size_t materialCount = materialTable.size();
+    std::vector<uint16_t> materialMap(particles.materialTable.size());
+
+    for (size_t i = 0; i < materialMap.size(); i++) {
+        if (!addMaterial(particles.materialTable[i], materialMap[i])) {
+            materialTable.resize(materialCount);
+            return false;
+        }
+    }
+
+    positions.insert(positions.end(), particles.positions.begin(), particles.positions.end());
+    velocities.insert(velocities.end(), particles.velocities.begin(), particles.velocities.end());
+    volumes.insert(volumes.end(), particles.volumes.begin(), particles.volumes.end());
+    affines.insert(affines.end(), particles.affines.begin(), particles.affines.end());
+    deformationGradients.insert(deformationGradients.end(),
+        particles.deformationGradients.begin(), particles.deformationGradients.end());
+    materials.resize(offset + particles.materials.size());
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, particles.materials.size()),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t i = range.begin(); i < range.end(); i++)
+            materials[offset + i] = materialMap[particles.materials[i]];
+    });
+
+    return true;
+}
+bool ParticleSystem::append(
+    const glm::vec3 * positions, size_t count,
+    const Material & material, float volume) {
+    size_t offset = getParticleCount();
+    uint16_t materialIndex;
+
+    if (!addMaterial(material, materialIndex))
+        return false;
+
+    resize(offset + count);
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, count),
+        [&](const tbb::blocked_range<size_t> & range) {
+        std::copy(positions + range.begin(), positions + range.end(),
+            this->positions.begin() + offset + range.begin());
+
+        for (size_t i = offset + range.begin(); i < offset + range.end(); i++) {
+            velocities[i] = material.getVelocity();
+            volumes[i] = volume;
+            materials[i] = materialIndex;
+        }
+    });
+
+    return true;
+}
+
+ParticleSystem & ParticleSystem::permute(Span<const uint32_t> order) {
+    permuteArray(positions, order);
+    permuteArray(velocities, order);
+    permuteArray(volumes, order);
+    permuteArray(affines, order);
+    permuteArray(deformationGradients, order);
+    permuteArray(materials, order);
+
+    return *this;
+}
+
+ParticleSystem & ParticleSystem::setMaterial(uint16_t index, const Material & material) {
+    if (index >= materialTable.size())
+        materialTable.resize(index + 1);
+
+    materialTable[index] = material;
+
+    return *this;
+}
+
+bool ParticleSystem::addMaterial(const Material & material, uint16_t & index) {
+    auto iterator = std::find(materialTable.begin(), materialTable.end(), material);
+
+    if (iterator == materialTable.end()) {
+        if (materialTable.size() > std::numeric_limits<uint16_t>::max())
+            return false;
+
+        materialTable.push_back(material);
+        iterator = materialTable.end() - 1;
+    }
+
+    index = (uint16_t)(iterator - materialTable.begin());
+
+    return true;
+}
+
+Span<glm::vec3> ParticleSystem::getPositions() {
+    return makeSpan(positions);
+}
+Span<glm::vec3> ParticleSystem::getVelocities() {
+    return makeSpan(velocities);
+}
+Span<float> ParticleSystem::getVolumes() {
+    return makeSpan(volumes);
+}
+Span<glm::mat3> ParticleSystem::getAffines() {
+    return makeSpan(affines);
+}
+Span<glm::mat3> ParticleSystem::getDeformationGradients() {
+    return makeSpan(deformationGradients);
+}
+Span<uint16_t> ParticleSystem::getMaterials() {
+    return makeSpan(materials);
+}
+
+Span<const glm::vec3> ParticleSystem::getPositions() const {
+    return makeSpan(positions);
+}
+Span<const glm::vec3> ParticleSystem::getVelocities() const {
+    return makeSpan(velocities);
+}
+Span<const float> ParticleSystem::getVolumes() const {
+    return makeSpan(volumes);
+}
+Span<const glm::mat3> ParticleSystem::getAffines() const {
+    return makeSpan(affines);
+}
+Span<const glm::mat3> ParticleSystem::getDeformationGradients() const {
+    return makeSpan(deformationGradients);
+}
+Span<const uint16_t> ParticleSystem::getMaterials() const {
+    return makeSpan(materials);
+}
+Span<const Material> ParticleSystem::getMaterialTable() const {
+    return Span<const Material>(materialTable.data(), materialTable.size());
+}
+const Material & ParticleSystem::getMaterial(uint16_t index) const {
+    return materialTable[index];
+}
+
+size_t ParticleSystem::getParticleCount() const {
+    return positions.size();
+}
+bool ParticleSystem::empty() const {
+    return positions.empty();
+}
+
+MPM_NAMESPACE_END
@@ -0,0 +1,98 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <mpm/Random.h>
+
+MPM_NAMESPACE_BEGIN
+
+static const uint32_t PHILOX_M0 = 0xD2511F53;
+static const uint32_t PHILOX_M1 = 0xCD9E8D57;
+static const uint32_t PHILOX_W0 = 0x9E3779B9;
+static const uint32_t PHILOX_W1 = 0xBB67AE85;
+static const int PHILOX_ROUNDS = 10;
+
+static void multiply(uint32_t a, uint32_t b, uint32_t & high, uint32_t & low) {
+    uint64_t product = (uint64_t)a * b;
+
+    high = (uint32_t)(product >> 32);
+    low = (uint32_t)product;
+}
+
+RandomGenerator::RandomGenerator(uint64_t seed, uint64_t stream) {
+    key[0] = (uint32_t)seed;
+    key[1] = (uint32_t)(seed >> 32);
+
+    counter[0] = 0;
+    counter[1] = 0;
+    counter[2] = (uint32_t)stream;
+    counter[3] = (uint32_t)(stream >> 32);
+
+    index = 4;
+}
+RandomGenerator::~RandomGenerator() {}
+
+RandomGenerator & RandomGenerator::advance() {
+    uint32_t state[4] = {counter[0], counter[1], counter[2], counter[3]};
+    uint32_t roundKey[2] = {key[0], key[1]};
+
+    for (int round = 0; round < PHILOX_ROUNDS; round++) {
+        uint32_t high0, low0, high1, low1;
+
+        multiply(PHILOX_M0, state[0], high0, low0);
+        multiply(PHILOX_M1, state[2], high1, low1);
+
+        state[0] = high1 ^ state[1] ^ roundKey[0];
+        state[1] = low1;
+        state[2] = high0 ^ state[3] ^ roundKey[1];
+        state[3] = low0;
+
+        roundKey[0] += PHILOX_W0;
+        roundKey[1] += PHILOX_W1;
+    }
+
+    for (int i = 0; i < 4; i++)
+        results[i] = state[i];
+
+    if (++counter[0] == 0)
+        counter[1]++;
+
+    index = 0;
+
+    return *this;
+}
+
+uint32_t RandomGenerator::generate() {
+    if (index == 4)
+        advance();
+
+    return results[index++];
+}
+float RandomGenerator::generateUniform() {
+    return (generate() >> 8) * (1.0f / 16777216.0f);
+}
+
+MPM_NAMESPACE_END
@@ -0,0 +1,1467 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <mpm/Solver.h>
+#include <mpm/Kernel.h>
+#include <mpm/Constitutive.h>
+
+#include <glm/vec2.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+#include <glm/common.hpp>
+
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/parallel_sort.h>
+#include <tbb/blocked_range.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+
+MPM_NAMESPACE_BEGIN
+
+template <int dimension>
+static glm::vec3 getWeightGradient(const KernelBatch & batch, size_t q, int i, int j, int k) {
+    float wx = batch.weights[0][i][q];
+    float wy = batch.weights[1][j][q];
+    float wz = dimension == 3 ? batch.weights[2][k][q] : 1.0f;
+
+    return glm::vec3(
+        batch.gradients[0][i][q] * wy * wz,
+        wx * batch.gradients[1][j][q] * wz,
+        dimension == 3 ? wx * wy * batch.gradients[2][k][q] : 0.0f);
+}
+
+static void storeLane(const glm::mat3 & matrix, float (*lanes)[KERNEL_BATCH_SIZE], size_t q) {
+    for (int i = 0; i < 9; i++)
+        lanes[i][q] = (&matrix[0][0])[i];
+}
+static glm::mat3 loadLane(const float (*lanes)[KERNEL_BATCH_SIZE], size_t q) {
+    glm::mat3 matrix;
+
+    for (int i = 0; i < 9; i++)
+        (&matrix[0][0])[i] = lanes[i][q];
+
+    return matrix;
+}
+static void loadMaterials(
+    const ParticleSystem & particles, size_t first, size_t count,
+    float * masses, float * lambdas, float * mus) {
+    Span<const uint16_t> materials = particles.getMaterials();
+
+    uint16_t index = materials[first];
+    bool homogeneous = true;
+
+    for (size_t q = 1; homogeneous && q < count; q++)
+        homogeneous = materials[first + q] == index;
+
+    if (homogeneous) {
+        const Material & material = particles.getMaterial(index);
+
+        if (masses)
+            std::fill(masses, masses + count, material.getMass());
+
+        std::fill(lambdas, lambdas + count, material.getLambda());
+        std::fill(mus, mus + count, material.getMu());
+
+        return;
+    }
+
+    for (size_t q = 0; q < count; q++) {
+        const Material & material = particles.getMaterial(materials[first + q]);
+
+        if (masses)
+            masses[q] = material.getMass();
+
+        lambdas[q] = material.getLambda();
+        mus[q] = material.getMu();
+    }
+}
+
+template <Interpolation interpolation, int dimension>
+static void scatter(
+    const ParticleSystem & particles, const Grid & grid, ConstitutiveModel model,
+    float timeStep, bool stressed, size_t begin, size_t end, Grid::LocalBuffer * buffer) {
+    const int size = Stencil<interpolation>::SIZE;
+    const int depth = dimension == 3 ? size : 1;
+    const bool gradientTransfer = interpolation == Interpolation::Linear;
+
+    float spacing = grid.getSpacing();
+    float inverseSpacing = 1.0 / spacing;
+    float inertia = interpolation == Interpolation::Cubic ? 3.0 : 4.0;
+    float stressFactor = -inertia * timeStep * inverseSpacing * inverseSpacing;
+
+    Span<const glm::vec3> positions = particles.getPositions();
+    Span<const glm::vec3> velocities = particles.getVelocities();
+    Span<const float> volumes = particles.getVolumes();
+    Span<const glm::mat3> affines = particles.getAffines();
+    Span<const glm::mat3> deformationGradients = particles.getDeformationGradients();
+
+    Grid::Neighborhood neighborhood;
+    glm::ivec3 cachedBlock(std::numeric_limits<int>::max());
+
+    KernelBatch batch;
+    StressBatch stressBatch;
+    float masses[KERNEL_BATCH_SIZE];
+
+    for (size_t first = begin; first < end; first += KERNEL_BATCH_SIZE) {
+        size_t count = std::min(end - first, KERNEL_BATCH_SIZE);
+
+        Kernel::computeWeights(interpolation,
+            &positions[first].x, count, inverseSpacing, batch);
+        loadMaterials(particles, first, count, masses, stressBatch.lambdas, stressBatch.mus);
+
+        for (size_t q = 0; stressed && q < count; q++) {
+            const float * deformationGradient = &deformationGradients[first + q][0][0];
+
+            for (int i = 0; i < 9; i++)
+                stressBatch.deformationGradients[i][q] = deformationGradient[i];
+        }
+
+        if (stressed)
+            Constitutive::computeStresses(model, stressBatch, count);
+
+        for (size_t q = 0; q < count; q++) {
+            size_t p = first + q;
+
+            glm::ivec3 base(batch.bases[0][q], batch.bases[1][q], batch.bases[2][q]);
+            glm::vec3 origin = glm::vec3(base) * spacing - positions[p];
+
+            if (dimension == 2)
+                origin.z = 0;
+
+            glm::ivec3 block = Grid::Layout<dimension>::getBlockCoordinate(base);
+            glm::ivec3 local = base - block * Grid::Layout<dimension>::getBlockSize();
+
+            if (block != cachedBlock) {
+                neighborhood.fetch(grid, block);
+
+                if (buffer)
+                    buffer->redirect(grid, neighborhood);
+
+                cachedBlock = block;
+            }
+
+            float mass = masses[q];
+            float volume = volumes[p];
+
+            glm::mat3 stress(0);
+
+            for (int i = 0; stressed && i < 9; i++)
+                (&stress[0][0])[i] = stressBatch.stresses[i][q];
+            glm::mat3 affine = mass * affines[p];
+            glm::vec3 momentum = mass * velocities[p];
+
+            if (!gradientTransfer)
+                affine = stressFactor * volume * stress + affine;
+
+            for (int i = 0; i < size; i++) {
+                for (int j = 0; j < size; j++) {
+                    for (int k = 0; k < depth; k++) {
+                        float wx = batch.weights[0][i][q];
+                        float wy = batch.weights[1][j][q];
+                        float wz = dimension == 3 ? batch.weights[2][k][q] : 1.0f;
+
+                        glm::vec3 offset = origin + glm::vec3(i, j, k) * spacing;
+                        float weight = wx * wy * wz;
+
+                        int x = local.x + i;
+                        int y = local.y + j;
+                        int z = local.z + k;
+
+                        Grid::Block * target = neighborhood.getBlock<dimension>(x, y, z);
+                        size_t node = Grid::Neighborhood::getNode<dimension>(x, y, z);
+
+                        glm::vec3 contribution = weight * (momentum + affine * offset);
+
+                        if (gradientTransfer) {
+                            contribution -= timeStep * volume
+                                * (stress * getWeightGradient<dimension>(batch, q, i, j, k));
+                        }
+
+                        target->mass[node] += weight * mass;
+                        target->momentum[node] += contribution;
+                    }
+                }
+            }
+        }
+    }
+}
+
+static glm::vec2 measureParticle(
+    const glm::vec3 & velocity, float mass, float volume, float lambda, float mu) {
+    float stiffness = mass > 0 ? (lambda + 2.0f * mu) * volume / mass : 0.0f;
+    return glm::vec2(glm::dot(velocity, velocity), stiffness);
+}
+
+template <Interpolation interpolation, int dimension>
+static glm::vec2 gather(
+    ParticleSystem & particles, const Grid & grid, float timeStep, size_t begin, size_t end) {
+    const int size = Stencil<interpolation>::SIZE;
+    const int depth = dimension == 3 ? size : 1;
+    const bool gradientTransfer = interpolation == Interpolation::Linear;
+
+    float inverseSpacing = 1.0 / grid.getSpacing();
+    float inertia = (interpolation == Interpolation::Cubic ? 3.0 : 4.0) * inverseSpacing;
+
+    Span<glm::vec3> positions = particles.getPositions();
+    Span<glm::vec3> velocities = particles.getVelocities();
+    Span<glm::mat3> affines = particles.getAffines();
+    Span<glm::mat3> deformationGradients = particles.getDeformationGradients();
+    Span<const float> volumes = particles.getVolumes();
+    Span<const uint16_t> materials = particles.getMaterials();
+    Span<const Material> materialTable = particles.getMaterialTable();
+
+    bool plastic = false;
+
+    for (const Material & material : materialTable)
+        plastic = plastic || material.getPlasticityModel() != PlasticityModel::None;
+
+    Grid::Neighborhood neighborhood;
+    glm::ivec3 cachedBlock(std::numeric_limits<int>::max());
+
+    KernelBatch batch;
+    PlasticityBatch plasticityBatch;
+    size_t plasticLanes[KERNEL_BATCH_SIZE];
+
+    float masses[KERNEL_BATCH_SIZE];
+    float lambdas[KERNEL_BATCH_SIZE];
+    float mus[KERNEL_BATCH_SIZE];
+
+    glm::vec2 maxima(0);
+
+    for (size_t first = begin; first < end; first += KERNEL_BATCH_SIZE) {
+        size_t count = std::min(end - first, KERNEL_BATCH_SIZE);
+
+        Kernel::computeWeights(interpolation,
+            &positions[first].x, count, inverseSpacing, batch);
+        loadMaterials(particles, first, count, masses, lambdas, mus);
+
+        for (size_t q = 0; q < count; q++) {
+            size_t p = first + q;
+
+            glm::ivec3 base(batch.bases[0][q], batch.bases[1][q], batch.bases[2][q]);
+            glm::vec3 fx = positions[p] * inverseSpacing - glm::vec3(base);
+
+            if (dimension == 2)
+                fx.z = 0;
+
+            glm::ivec3 block = Grid::Layout<dimension>::getBlockCoordinate(base);
+            glm::ivec3 local = base - block * Grid::Layout<dimension>::getBlockSize();
+
+            if (block != cachedBlock) {
+                neighborhood.fetch(grid, block);
+                cachedBlock = block;
+            }
+
+            glm::vec3 velocity(0);
+            glm::mat3 affine(0);
+
+            for (int i = 0; i < size; i++) {
+                for (int j = 0; j < size; j++) {
+                    for (int k = 0; k < depth; k++) {
+                        float wx = batch.weights[0][i][q];
+                        float wy = batch.weights[1][j][q];
+                        float wz = dimension == 3 ? batch.weights[2][k][q] : 1.0f;
+
+                        float weight = wx * wy * wz;
+
+                        int x = local.x + i;
+                        int y = local.y + j;
+                        int z = local.z + k;
+
+                        const glm::vec3 & nodeVelocity = neighborhood.getBlock<dimension>(x, y, z)
+                            ->velocity[Grid::Neighborhood::getNode<dimension>(x, y, z)];
+
+                        velocity += weight * nodeVelocity;
+
+                        if (gradientTransfer) {
+                            affine += glm::outerProduct(nodeVelocity,
+                                getWeightGradient<dimension>(batch, q, i, j, k));
+                        }
+                        else {
+                            glm::vec3 offset = glm::vec3(i, j, k) - fx;
+                            affine += inertia * weight * glm::outerProduct(nodeVelocity, offset);
+                        }
+                    }
+                }
+            }
+
+            velocities[p] = velocity;
+            affines[p] = affine;
+            positions[p] += timeStep * velocity;
+            deformationGradients[p] = (glm::mat3(1.0) + timeStep * affine)
+                * deformationGradients[p];
+
+            maxima = glm::max(maxima,
+                measureParticle(velocity, masses[q], volumes[p], lambdas[q], mus[q]));
+        }
+
+        if (!plastic)
+            continue;
+
+        size_t plasticCount = 0;
+
+        for (size_t q = 0; q < count; q++) {
+            const Material & material = materialTable[materials[first + q]];
+            PlasticityModel model = material.getPlasticityModel();
+
+            if (model == PlasticityModel::None)
+                continue;
+
+            const float * deformationGradient = &deformationGradients[first + q][0][0];
+
+            for (int i = 0; i < 9; i++)
+                plasticityBatch.deformationGradients[i][plasticCount] = deformationGradient[i];
+
+            plasticityBatch.yieldStrains[plasticCount] =
+                model == PlasticityModel::Maxwell ? 0.0f : material.getYieldStrain();
+            plasticityBatch.relaxations[plasticCount] =
+                timeStep / (material.getRelaxationTime() + timeStep);
+
+            plasticLanes[plasticCount++] = q;
+        }
+
+        if (plasticCount == 0)
+            continue;
+
+        Constitutive::computeReturnMapping(plasticityBatch, plasticCount);
+
+        for (size_t n = 0; n < plasticCount; n++) {
+            float * deformationGradient = &deformationGradients[first + plasticLanes[n]][0][0];
+
+            for (int i = 0; i < 9; i++)
+                deformationGradient[i] = plasticityBatch.deformationGradients[i][n];
+        }
+    }
+
+    return maxima;
+}
+
+template <Interpolation interpolation, int dimension, typename Compute>
+static void exchange(
+    const ParticleSystem & particles, const Grid & grid, size_t begin, size_t end,
+    Grid::LocalBuffer * buffer, const Compute & compute) {
+    const int size = Stencil<interpolation>::SIZE;
+    const int depth = dimension == 3 ? size : 1;
+
+    float inverseSpacing = 1.0 / grid.getSpacing();
+
+    Span<const glm::vec3> positions = particles.getPositions();
+
+    Grid::Neighborhood source;
+    Grid::Neighborhood target;
+    glm::ivec3 sourceBlock(std::numeric_limits<int>::max());
+    glm::ivec3 targetBlock(std::numeric_limits<int>::max());
+
+    KernelBatch batch;
+    glm::mat3 gradients[KERNEL_BATCH_SIZE];
+    glm::mat3 results[KERNEL_BATCH_SIZE];
+
+    for (size_t first = begin; first < end; first += KERNEL_BATCH_SIZE) {
+        size_t count = std::min(end - first, KERNEL_BATCH_SIZE);
+
+        Kernel::computeWeights(interpolation,
+            &positions[first].x, count, inverseSpacing, batch);
+
+        for (size_t q = 0; q < count; q++) {
+            glm::ivec3 base(batch.bases[0][q], batch.bases[1][q], batch.bases[2][q]);
+            glm::ivec3 block = Grid::Layout<dimension>::getBlockCoordinate(base);
+            glm::ivec3 local = base - block * Grid::Layout<dimension>::getBlockSize();
+
+            if (block != sourceBlock) {
+                source.fetch(grid, block);
+                sourceBlock = block;
+            }
+
+            glm::mat3 gradient(0);
+
+            for (int i = 0; i < size; i++) {
+                for (int j = 0; j < size; j++) {
+                    for (int k = 0; k < depth; k++) {
+                        int x = local.x + i;
+                        int y = local.y + j;
+                        int z = local.z + k;
+
+                        const glm::vec3 & velocity = source.getBlock<dimension>(x, y, z)
+                            ->velocity[Grid::Neighborhood::getNode<dimension>(x, y, z)];
+
+                        gradient += glm::outerProduct(velocity,
+                            getWeightGradient<dimension>(batch, q, i, j, k));
+                    }
+                }
+            }
+
+            gradients[q] = gradient;
+        }
+
+        compute(first, count, gradients, results);
+
+        for (size_t q = 0; q < count; q++) {
+            glm::ivec3 base(batch.bases[0][q], batch.bases[1][q], batch.bases[2][q]);
+            glm::ivec3 block = Grid::Layout<dimension>::getBlockCoordinate(base);
+            glm::ivec3 local = base - block * Grid::Layout<dimension>::getBlockSize();
+
+            if (block != targetBlock) {
+                target.fetch(grid, block);
+
+                if (buffer)
+                    buffer->redirect(grid, target);
+
+                targetBlock = block;
+            }
+
+            for (int i = 0; i < size; i++) {
+                for (int j = 0; j < size; j++) {
+                    for (int k = 0; k < depth; k++) {
+                        int x = local.x + i;
+                        int y = local.y + j;
+                        int z = local.z + k;
+
+                        target.getBlock<dimension>(x, y, z)
+                            ->momentum[Grid::Neighborhood::getNode<dimension>(x, y, z)] +=
+                            results[q] * getWeightGradient<dimension>(batch, q, i, j, k);
+                    }
+                }
+            }
+        }
+    }
+}
+
+static float computeNorm(const glm::mat3 & matrix) {
+    return std::sqrt(glm::dot(matrix[0], matrix[0])
+        + glm::dot(matrix[1], matrix[1]) + glm::dot(matrix[2], matrix[2]));
+}
+
+template <typename Function>
+static void forEachNode(size_t count, const Function & function) {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, count),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t i = range.begin(); i < range.end(); i++)
+            function(i);
+    });
+}
+template <typename Function>
+static double sumNodes(size_t count, const Function & function) {
+    return tbb::parallel_reduce(tbb::blocked_range<size_t>(0, count), 0.0,
+        [&](const tbb::blocked_range<size_t> & range, double value) {
+        for (size_t i = range.begin(); i < range.end(); i++)
+            value += function(i);
+
+        return value;
+    }, [](double a, double b) {
+        return a + b;
+    });
+}
+
+Solver & Solver::measure() {
+    Span<const glm::vec3> velocities = particles.getVelocities();
+    Span<const float> volumes = particles.getVolumes();
+    Span<const uint16_t> materials = particles.getMaterials();
+
+    glm::vec2 maxima = tbb::parallel_reduce(
+        tbb::blocked_range<size_t>(0, particles.getParticleCount()), glm::vec2(0),
+        [&](const tbb::blocked_range<size_t> & range, glm::vec2 value) {
+        for (size_t p = range.begin(); p < range.end(); p++) {
+            const Material & material = particles.getMaterial(materials[p]);
+
+            value = glm::max(value, measureParticle(velocities[p], material.getMass(),
+                volumes[p], material.getLambda(), material.getMu()));
+        }
+
+        return value;
+    }, [](const glm::vec2 & a, const glm::vec2 & b) {
+        return glm::max(a, b);
+    });
+
+    maximumSpeed = std::sqrt(maxima.x);
+    maximumWaveSpeed = std::sqrt(maxima.y);
+    measured = true;
+
+    return *this;
+}
+Solver & Solver::rasterize() {
+    if (sorting || scatterStrategy == ScatterStrategy::Coloring)
+        sorter.sort(particles, gridSpacing, interpolation, dimension);
+
+    grid.setSpacing(gridSpacing);
+    grid.setDimension(dimension);
+    grid.activate(particles.getPositions(), interpolation);
+
+    if (scatterStrategy == ScatterStrategy::Coloring)
+        partition();
+
+    return *this;
+}
+Solver & Solver::partition() {
+    Span<const uint64_t> keys = sorter.getKeys();
+
+    tbb::enumerable_thread_specific<std::vector<size_t>> localStarts;
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, keys.size()),
+        [&](const tbb::blocked_range<size_t> & range) {
+        std::vector<size_t> & starts = localStarts.local();
+
+        for (size_t i = range.begin(); i < range.end(); i++) {
+            if (i == 0 || keys[i] != keys[i - 1])
+                starts.push_back(i);
+        }
+    });
+
+    std::vector<size_t> starts;
+
+    for (const std::vector<size_t> & local : localStarts)
+        starts.insert(starts.end(), local.begin(), local.end());
+
+    tbb::parallel_sort(starts.begin(), starts.end());
+    starts.push_back(keys.size());
+
+    for (int color = 0; color < 8; color++)
+        partitions[color].clear();
+
+    for (size_t i = 0; i + 1 < starts.size(); i++)
+        partitions[keys[starts[i]] & 7].push_back(Partition(starts[i], starts[i + 1]));
+
+    return *this;
+}
+template <typename Function>
+Solver & Solver::transfer(const Function & function) {
+    if (scatterStrategy == ScatterStrategy::Coloring) {
+        for (int color = 0; color < 8; color++) {
+            const std::vector<Partition> & colorPartitions = partitions[color];
+
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, colorPartitions.size()),
+                [&](const tbb::blocked_range<size_t> & range) {
+                for (size_t i = range.begin(); i < range.end(); i++)
+                    function(colorPartitions[i].first, colorPartitions[i].second, nullptr);
+            });
+        }
+    }
+    else {
+        for (Grid::LocalBuffer & buffer : localBuffers)
+            buffer.reset(grid.getBlockCount());
+
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, particles.getParticleCount()),
+            [&](const tbb::blocked_range<size_t> & range) {
+            function(range.begin(), range.end(), &localBuffers.local());
+        });
+
+        std::vector<const Grid::LocalBuffer *> buffers;
+
+        for (const Grid::LocalBuffer & buffer : localBuffers)
+            buffers.push_back(&buffer);
+
+        grid.reduce(buffers);
+    }
+
+    return *this;
+}
+template <Interpolation interpolation, int dimension>
+Solver & Solver::particleToGrid() {
+    return transfer([this](size_t begin, size_t end, Grid::LocalBuffer * buffer) {
+        scatter<interpolation, dimension>(particles, grid, constitutiveModel, substepSize,
+            integration == Integration::Explicit, begin, end, buffer);
+    });
+}
+template <int dimension>
+Solver & Solver::updateGrid() {
+    float boundary = 2.0 * gridSpacing;
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, grid.getBlockCount()),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t b = range.begin(); b < range.end(); b++) {
+            Grid::Block & block = grid.getBlock(b);
+
+            for (size_t i = 0; i < Grid::BLOCK_VOLUME; i++) {
+                float mass = block.mass[i];
+
+                if (mass <= 0)
+                    continue;
+
+                glm::vec3 velocity = block.momentum[i] / mass + substepSize * gravity;
+                glm::vec3 position = grid.getPosition(block, i);
+
+                if (dimension == 2)
+                    velocity.z = 0;
+
+                for (int axis = 0; axis < dimension; axis++) {
+                    if (position[axis] < minimumBound[axis] + boundary && velocity[axis] < 0)
+                        velocity[axis] = 0;
+                    if (position[axis] > maximumBound[axis] - boundary && velocity[axis] > 0)
+                        velocity[axis] = 0;
+                }
+
+                block.velocity[i] = velocity;
+            }
+        }
+    });
+
+    return *this;
+}
+template <int dimension>
+Solver & Solver::collide() {
+    if (colliders.empty())
+        return *this;
+
+    glm::vec3 blockExtent = glm::vec3(Grid::Layout<dimension>::getBlockSize() - 1) * gridSpacing;
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, grid.getBlockCount()),
+        [&](const tbb::blocked_range<size_t> & range) {
+        std::vector<std::unique_ptr<Collider::Sampler>> samplers(colliders.size());
+
+        for (size_t b = range.begin(); b < range.end(); b++) {
+            Grid::Block & block = grid.getBlock(b);
+            glm::vec3 lower = grid.getPosition(block, 0);
+            glm::vec3 upper = lower + blockExtent;
+
+            for (size_t c = 0; c < colliders.size(); c++) {
+                if (!colliders[c].overlaps(lower, upper))
+                    continue;
+
+                if (!samplers[c])
+                    samplers[c].reset(new Collider::Sampler(colliders[c]));
+
+                for (size_t i = 0; i < Grid::BLOCK_VOLUME; i++) {
+                    if (block.mass[i] <= 0)
+                        continue;
+
+                    glm::vec3 velocity = block.velocity[i];
+
+                    if (!samplers[c]->apply(grid.getPosition(block, i), velocity))
+                        continue;
+
+                    if (dimension == 2)
+                        velocity.z = 0;
+
+                    block.velocity[i] = velocity;
+                }
+            }
+        }
+    });
+
+    return *this;
+}
+template <Interpolation interpolation, int dimension, typename Compute>
+Solver & Solver::exchangeNodes(
+    const AlignedArray<glm::vec3> & input, AlignedArray<glm::vec3> & output,
+    const Compute & compute) {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, grid.getBlockCount()),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t b = range.begin(); b < range.end(); b++) {
+            Grid::Block & block = grid.getBlock(b);
+
+            for (size_t i = 0; i < Grid::BLOCK_VOLUME; i++) {
+                block.velocity[i] = input[b * Grid::BLOCK_VOLUME + i];
+                block.momentum[i] = glm::vec3(0);
+            }
+        }
+    });
+
+    transfer([&](size_t begin, size_t end, Grid::LocalBuffer * buffer) {
+        exchange<interpolation, dimension>(particles, grid, begin, end, buffer, compute);
+    });
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, grid.getBlockCount()),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t b = range.begin(); b < range.end(); b++) {
+            const Grid::Block & block = grid.getBlock(b);
+
+            for (size_t i = 0; i < Grid::BLOCK_VOLUME; i++)
+                output[b * Grid::BLOCK_VOLUME + i] = block.momentum[i];
+        }
+    });
+
+    return *this;
+}
+template <Interpolation interpolation, int dimension>
+double Solver::computeForces(
+    const AlignedArray<glm::vec3> & velocities, AlignedArray<glm::vec3> & forces) {
+    Span<const float> volumes = particles.getVolumes();
+    Span<const glm::mat3> deformationGradients = particles.getDeformationGradients();
+
+    tbb::enumerable_thread_specific<double> localEnergies(0.0);
+
+    exchangeNodes<interpolation, dimension>(velocities, forces,
+        [&](size_t first, size_t count, const glm::mat3 * gradients, glm::mat3 * results) {
+        StressBatch stressBatch;
+        SvdBatch svdBatch;
+
+        loadMaterials(particles, first, count, nullptr, stressBatch.lambdas, stressBatch.mus);
+
+        for (size_t q = 0; q < count; q++) {
+            size_t p = first + q;
+
+            glm::mat3 trial = (glm::mat3(1.0) + substepSize * gradients[q])
+                * deformationGradients[p];
+
+            trialDeformationGradients[p] = trial;
+            storeLane(trial, stressBatch.deformationGradients, q);
+
+            if (constitutiveModel == ConstitutiveModel::FixedCorotated)
+                storeLane(trial, svdBatch.matrices, q);
+        }
+
+        Constitutive::computeStresses(constitutiveModel, stressBatch, count);
+
+        if (constitutiveModel == ConstitutiveModel::FixedCorotated)
+            Constitutive::computeSvd(svdBatch, count);
+
+        double & energy = localEnergies.local();
+
+        for (size_t q = 0; q < count; q++) {
+            size_t p = first + q;
+
+            const glm::mat3 & trial = trialDeformationGradients[p];
+            glm::mat3 stress = loadLane(stressBatch.stresses, q);
+
+            float lambda = stressBatch.lambdas[q];
+            float mu = stressBatch.mus[q];
+            float density;
+
+            if (constitutiveModel == ConstitutiveModel::FixedCorotated) {
+                glm::vec3 sigma(svdBatch.sigma[0][q], svdBatch.sigma[1][q], svdBatch.sigma[2][q]);
+                glm::vec3 stretch = sigma - glm::vec3(1.0);
+                float dilation = sigma.x * sigma.y * sigma.z - 1.0f;
+
+                density = mu * glm::dot(stretch, stretch) + 0.5f * lambda * dilation * dilation;
+            }
+            else {
+                float determinant = glm::determinant(trial);
+                glm::mat3 difference = trial - glm::mat3(1.0);
+                float logJ = std::log(std::max(determinant, (float)MPM_EPS));
+                float trace = difference[0][0] + difference[1][1] + difference[2][2];
+
+                density = determinant > MPM_EPS ? 0.5f * mu * (computeNorm(difference)
+                    * computeNorm(difference) + 2.0f * trace) - mu * logJ
+                    + 0.5f * lambda * logJ * logJ : std::numeric_limits<float>::infinity();
+            }
+
+            energy += volumes[p] * density;
+            results[q] = -volumes[p] * stress
+                * glm::transpose(deformationGradients[p] * glm::inverse(trial));
+        }
+    });
+
+    double energy = 0;
+
+    for (double localEnergy : localEnergies)
+        energy += localEnergy;
+
+    return energy;
+}
+template <Interpolation interpolation, int dimension>
+Solver & Solver::multiplyHessian(
+    const AlignedArray<glm::vec3> & directions, AlignedArray<glm::vec3> & products) {
+    Span<const float> volumes = particles.getVolumes();
+    Span<const glm::mat3> deformationGradients = particles.getDeformationGradients();
+
+    exchangeNodes<interpolation, dimension>(directions, products,
+        [&](size_t first, size_t count, const glm::mat3 * gradients, glm::mat3 * results) {
+        StressBatch forward;
+        StressBatch backward;
+        float steps[KERNEL_BATCH_SIZE];
+
+        loadMaterials(particles, first, count, nullptr, forward.lambdas, forward.mus);
+
+        if (constitutiveModel == ConstitutiveModel::NeoHookean) {
+            for (size_t q = 0; q < count; q++) {
+                size_t p = first + q;
+
+                const glm::mat3 & trial = trialDeformationGradients[p];
+                glm::mat3 differential = gradients[q] * deformationGradients[p];
+                glm::mat3 inverse = glm::inverse(trial);
+                glm::mat3 inverseTranspose = glm::transpose(inverse);
+                glm::mat3 product = inverse * differential;
+
+                float lambda = forward.lambdas[q];
+                float mu = forward.mus[q];
+                float logJ = std::log(std::max(glm::determinant(trial), (float)MPM_EPS));
+
+                glm::mat3 stress = mu * differential
+                    + (mu - lambda * logJ) * inverseTranspose
+                    * glm::transpose(differential) * inverseTranspose
+                    + lambda * (product[0][0] + product[1][1] + product[2][2]) * inverseTranspose;
+
+                results[q] = volumes[p] * stress * glm::transpose(deformationGradients[p]);
+            }
+
+            return;
+        }
+
+        std::copy(forward.lambdas, forward.lambdas + count, backward.lambdas);
+        std::copy(forward.mus, forward.mus + count, backward.mus);
+
+        for (size_t q = 0; q < count; q++) {
+            size_t p = first + q;
+
+            const glm::mat3 & trial = trialDeformationGradients[p];
+            glm::mat3 differential = gradients[q] * deformationGradients[p];
+
+            float norm = computeNorm(differential);
+            float step = norm > 0 ? 1.0e-3f * std::max(computeNorm(trial), 1.0f) / norm : 0.0f;
+
+            steps[q] = step;
+            storeLane(trial + step * differential, forward.deformationGradients, q);
+            storeLane(trial - step * differential, backward.deformationGradients, q);
+        }
+
+        Constitutive::computeStresses(constitutiveModel, forward, count);
+        Constitutive::computeStresses(constitutiveModel, backward, count);
+
+        for (size_t q = 0; q < count; q++) {
+            size_t p = first + q;
+
+            if (steps[q] <= 0) {
+                results[q] = glm::mat3(0);
+                continue;
+            }
+
+            glm::mat3 forwardGradient = loadLane(forward.deformationGradients, q);
+            glm::mat3 backwardGradient = loadLane(backward.deformationGradients, q);
+
+            glm::mat3 stress = (loadLane(forward.stresses, q)
+                * glm::transpose(glm::inverse(forwardGradient))
+                - loadLane(backward.stresses, q)
+                * glm::transpose(glm::inverse(backwardGradient))) / (2.0f * steps[q]);
+
+            results[q] = volumes[p] * stress * glm::transpose(deformationGradients[p]);
+        }
+    });
+
+    float scale = substepSize * substepSize;
+
+    forEachNode(products.size(), [&](size_t i) {
+        products[i] = nodeMasses[i] * directions[i] + scale * products[i];
+    });
+
+    return project(products);
+}
+template <Interpolation interpolation, int dimension>
+glm::dvec2 Solver::computeObjective() {
+    size_t count = nodeVelocities.size();
+    double potential = computeForces<interpolation, dimension>(nodeVelocities, nodeGradients);
+
+    forEachNode(count, [&](size_t i) {
+        nodeGradients[i] = nodeMasses[i] * (nodeVelocities[i] - nodeTargets[i])
+            - substepSize * nodeGradients[i];
+    });
+
+    project(nodeGradients);
+
+    double kinetic = sumNodes(count, [&](size_t i) {
+        glm::vec3 difference = nodeVelocities[i] - nodeTargets[i];
+        return 0.5f * nodeMasses[i] * glm::dot(difference, difference);
+    });
+    double norm = sumNodes(count, [&](size_t i) {
+        float mass = nodeMasses[i];
+        return mass > 0 ? glm::dot(nodeGradients[i], nodeGradients[i]) / mass : 0.0f;
+    });
+
+    return glm::dvec2(kinetic + potential, std::sqrt(norm));
+}
+Solver & Solver::precondition() {
+    size_t count = nodeResiduals.size();
+
+    if (preconditioner == Preconditioner::Multigrid) {
+        multigrid.apply(Span<const glm::vec3>(nodeResiduals.data(), count),
+            Span<glm::vec3>(nodePreconditioned.data(), count));
+
+        return project(nodePreconditioned);
+    }
+
+    forEachNode(count, [&](size_t i) {
+        float mass = nodeMasses[i];
+        nodePreconditioned[i] = mass > 0 ? nodeResiduals[i] / mass : glm::vec3(0);
+    });
+
+    return *this;
+}
+template <Interpolation interpolation, int dimension>
+size_t Solver::solveKrylov() {
+    size_t count = nodeResiduals.size();
+
+    forEachNode(count, [&](size_t i) {
+        nodeSteps[i] = glm::vec3(0);
+        nodeResiduals[i] = -nodeGradients[i];
+    });
+
+    precondition();
+    std::copy(nodePreconditioned.begin(), nodePreconditioned.end(), nodeDirections.begin());
+
+    double product = sumNodes(count, [&](size_t i) {
+        return glm::dot(nodeResiduals[i], nodePreconditioned[i]);
+    });
+    double tolerance = krylovTolerance * krylovTolerance * product;
+
+    size_t iteration = 0;
+
+    while (iteration < krylovIterations && product > 0) {
+        multiplyHessian<interpolation, dimension>(nodeDirections, nodeProducts);
+        iteration++;
+
+        double curvature = sumNodes(count, [&](size_t i) {
+            return glm::dot(nodeDirections[i], nodeProducts[i]);
+        });
+
+        if (curvature <= 0) {
+            if (iteration == 1)
+                std::copy(nodeDirections.begin(), nodeDirections.end(), nodeSteps.begin());
+
+            break;
+        }
+
+        float alpha = (float)(product / curvature);
+
+        forEachNode(count, [&](size_t i) {
+            nodeSteps[i] += alpha * nodeDirections[i];
+            nodeResiduals[i] -= alpha * nodeProducts[i];
+        });
+
+        precondition();
+
+        double next = sumNodes(count, [&](size_t i) {
+            return glm::dot(nodeResiduals[i], nodePreconditioned[i]);
+        });
+
+        if (next <= tolerance)
+            break;
+
+        float beta = (float)(next / product);
+
+        forEachNode(count, [&](size_t i) {
+            nodeDirections[i] = nodePreconditioned[i] + beta * nodeDirections[i];
+        });
+
+        product = next;
+    }
+
+    return iteration;
+}
+template <int dimension>
+Solver & Solver::prepareImplicit() {
+    size_t count = grid.getBlockCount() * Grid::BLOCK_VOLUME;
+    float boundary = 2.0 * gridSpacing;
+
+    trialDeformationGradients.resize(particles.getParticleCount());
+    nodeMasses.resize(count);
+    nodeConstraints.resize(count);
+    nodeTargets.resize(count);
+    nodeVelocities.resize(count);
+    nodeGradients.resize(count);
+    nodeResiduals.resize(count);
+    nodePreconditioned.resize(count);
+    nodeSteps.resize(count);
+    nodeDirections.resize(count);
+    nodeProducts.resize(count);
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, grid.getBlockCount()),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t b = range.begin(); b < range.end(); b++) {
+            const Grid::Block & block = grid.getBlock(b);
+
+            for (size_t i = 0; i < Grid::BLOCK_VOLUME; i++) {
+                size_t index = b * Grid::BLOCK_VOLUME + i;
+                float mass = block.mass[i];
+
+                nodeMasses[index] = std::max(mass, 0.0f);
+
+                if (mass <= 0) {
+                    nodeConstraints[index] = 7;
+                    nodeTargets[index] = glm::vec3(0);
+                    continue;
+                }
+
+                glm::vec3 velocity = block.momentum[i] / mass + substepSize * gravity;
+                glm::vec3 position = grid.getPosition(block, i);
+                uint8_t constraints = dimension == 2 ? 4 : 0;
+
+                for (int axis = 0; axis < dimension; axis++) {
+                    if (position[axis] < minimumBound[axis] + boundary && velocity[axis] < 0)
+                        constraints |= 1 << axis;
+                    if (position[axis] > maximumBound[axis] - boundary && velocity[axis] > 0)
+                        constraints |= 1 << axis;
+                }
+
+                nodeConstraints[index] = constraints;
+                nodeTargets[index] = velocity;
+            }
+        }
+    });
+
+    project(nodeTargets);
+    std::copy(nodeTargets.begin(), nodeTargets.end(), nodeVelocities.begin());
+
+    if (preconditioner == Preconditioner::Multigrid) {
+        if (!measured)
+            measure();
+
+        multigrid.build(grid, Span<const float>(nodeMasses.data(), count),
+            Span<const uint8_t>(nodeConstraints.data(), count),
+            substepSize * substepSize * maximumWaveSpeed * maximumWaveSpeed);
+    }
+
+    return *this;
+}
+Solver & Solver::project(AlignedArray<glm::vec3> & field) {
+    forEachNode(field.size(), [&](size_t i) {
+        uint8_t constraints = nodeConstraints[i];
+
+        for (int axis = 0; axis < 3; axis++) {
+            if (constraints & (1 << axis))
+                field[i][axis] = 0;
+        }
+    });
+
+    return *this;
+}
+template <Interpolation interpolation, int dimension>
+Solver & Solver::solveImplicit() {
+    prepareImplicit<dimension>();
+
+    size_t count = nodeVelocities.size();
+
+    glm::dvec2 objective = computeObjective<interpolation, dimension>();
+    double momentum = std::sqrt(sumNodes(count, [&](size_t i) {
+        return nodeMasses[i] * glm::dot(nodeTargets[i], nodeTargets[i]);
+    }));
+    double tolerance = newtonTolerance * std::max(objective.y, momentum);
+
+    for (size_t iteration = 0; iteration < newtonIterations; iteration++) {
+        if (objective.y <= tolerance)
+            break;
+
+        krylovIterationCount += solveKrylov<interpolation, dimension>();
+        newtonIterationCount++;
+
+        double slope = sumNodes(count, [&](size_t i) {
+            return glm::dot(nodeGradients[i], nodeSteps[i]);
+        });
+
+        if (!(slope < 0))
+            break;
+
+        float applied = 0;
+        float fraction = 1;
+        bool accepted = false;
+
+        for (int attempt = 0; attempt < 8 && !accepted; attempt++, fraction *= 0.5f) {
+            float increment = fraction - applied;
+
+            forEachNode(count, [&](size_t i) {
+                nodeVelocities[i] += increment * nodeSteps[i];
+            });
+
+            applied = fraction;
+
+            glm::dvec2 next = computeObjective<interpolation, dimension>();
+
+            if (next.x <= objective.x + 1.0e-4 * fraction * slope) {
+                objective = next;
+                accepted = true;
+            }
+        }
+
+        if (!accepted) {
+            forEachNode(count, [&](size_t i) {
+                nodeVelocities[i] -= applied * nodeSteps[i];
+            });
+
+            break;
+        }
+    }
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, grid.getBlockCount()),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t b = range.begin(); b < range.end(); b++) {
+            Grid::Block & block = grid.getBlock(b);
+
+            for (size_t i = 0; i < Grid::BLOCK_VOLUME; i++)
+                block.velocity[i] = nodeVelocities[b * Grid::BLOCK_VOLUME + i];
+        }
+    });
+
+    return *this;
+}
+template <Interpolation interpolation, int dimension>
+Solver & Solver::gridToParticle() {
+    glm::vec2 maxima = tbb::parallel_reduce(
+        tbb::blocked_range<size_t>(0, particles.getParticleCount()), glm::vec2(0),
+        [&](const tbb::blocked_range<size_t> & range, const glm::vec2 & value) {
+        return glm::max(value, gather<interpolation, dimension>(
+            particles, grid, substepSize, range.begin(), range.end()));
+    }, [](const glm::vec2 & a, const glm::vec2 & b) {
+        return glm::max(a, b);
+    });
+
+    maximumSpeed = std::sqrt(maxima.x);
+    maximumWaveSpeed = std::sqrt(maxima.y);
+    measured = true;
+
+    return *this;
+}
+template <Interpolation interpolation, int dimension>
+Solver & Solver::advance() {
+    rasterize();
+    particleToGrid<interpolation, dimension>();
+
+    if (integration == Integration::Implicit)
+        solveImplicit<interpolation, dimension>();
+    else
+        updateGrid<dimension>();
+
+    collide<dimension>();
+    gridToParticle<interpolation, dimension>();
+
+    return *this;
+}
+template <int dimension>
+Solver & Solver::dispatch() {
+    switch (interpolation) {
+    case Interpolation::Linear:
+        return advance<Interpolation::Linear, dimension>();
+    case Interpolation::Quadratic:
+        return advance<Interpolation::Quadratic, dimension>();
+    default:
+        return advance<Interpolation::Cubic, dimension>();
+    }
+}
+
+Solver::Solver() : Solver(0.1, 1.0e-4) {}
+Solver::Solver(float gridSpacing, float timeStep) {
+    this->gridSpacing = gridSpacing;
+    this->timeStep = timeStep;
+
+    gravity = glm::vec3(0, -9.81, 0);
+    minimumBound = glm::vec3(-10.0, 0, -10.0);
+    maximumBound = glm::vec3(10.0, 20.0, 10.0);
+    sorting = true;
+    scatterStrategy = ScatterStrategy::Coloring;
+    interpolation = Interpolation::Quadratic;
+    dimension = 3;
+    constitutiveModel = ConstitutiveModel::NeoHookean;
+    cflNumber = 0.5;
+    minimumTimeStep = 1.0e-6;
+    maximumTimeStep = 1.0e-2;
+    maximumSubsteps = 0;
+    substepCount = 0;
+    substepSize = timeStep;
+    maximumSpeed = 0;
+    maximumWaveSpeed = 0;
+    measured = false;
+    integration = Integration::Explicit;
+    newtonIterations = 8;
+    krylovIterations = 50;
+    newtonTolerance = 1.0e-3;
+    krylovTolerance = 1.0e-2;
+    preconditioner = Preconditioner::Multigrid;
+    newtonIterationCount = 0;
+    krylovIterationCount = 0;
+
+    setThreadCount(0);
+}
+Solver::~Solver() {}
+
+bool Solver::addParticles(const ParticleSystem & particles) {
+    if (!this->particles.append(particles))
+        return false;
+
+    measured = false;
+
+    return true;
+}
+Solver & Solver::clearParticles() {
+    particles.clear();
+    measured = false;
+
+    return *this;
+}
+Solver & Solver::addCollider(const Collider & collider) {
+    colliders.push_back(collider);
+    return *this;
+}
+Solver & Solver::clearColliders() {
+    colliders.clear();
+    return *this;
+}
+
+Solver & Solver::step() {
+    newtonIterationCount = 0;
+    krylovIterationCount = 0;
+
+    return substep(timeStep);
+}
+Solver & Solver::substep(float stepSize) {
+    if (particles.empty())
+        return *this;
+
+    substepSize = stepSize;
+
+    arena.execute([this]() {
+        if (dimension == 2)
+            dispatch<2>();
+        else
+            dispatch<3>();
+    });
+
+    for (Collider & collider : colliders)
+        collider.advance(stepSize);
+
+    return *this;
+}
+float Solver::advance(float duration) {
+    substepCount = 0;
+    newtonIterationCount = 0;
+    krylovIterationCount = 0;
+
+    if (particles.empty())
+        return 0;
+
+    if (!measured)
+        arena.execute([this]() { measure(); });
+
+    float remaining = duration;
+
+    while (remaining > MPM_EPS * duration) {
+        if (maximumSubsteps && substepCount >= maximumSubsteps)
+            break;
+
+        float stepSize = computeTimeStep();
+
+        if (remaining <= stepSize)
+            stepSize = remaining;
+        else if (remaining < 2.0f * stepSize)
+            stepSize = 0.5f * remaining;
+
+        substep(stepSize);
+
+        remaining -= stepSize;
+        substepCount++;
+    }
+
+    return remaining > MPM_EPS * duration ? remaining : 0;
+}
+
+float Solver::computeTimeStep() const {
+    float speed = integration == Integration::Implicit ?
+        maximumSpeed : std::max(maximumSpeed, maximumWaveSpeed);
+    float stepSize = speed > 0 ? cflNumber * gridSpacing / speed : maximumTimeStep;
+
+    return glm::clamp(stepSize, minimumTimeStep, maximumTimeStep);
+}
+
+Solver & Solver::setGridSpacing(float gridSpacing) {
+    this->gridSpacing = gridSpacing;
+    return *this;
+}
+Solver & Solver::setTimeStep(float timeStep) {
+    this->timeStep = timeStep;
+    return *this;
+}
+Solver & Solver::setGravity(const glm::vec3 & gravity) {
+    this->gravity = gravity;
+    return *this;
+}
+Solver & Solver::setBounds(const glm::vec3 & minimumBound, const glm::vec3 & maximumBound) {
+    this->minimumBound = minimumBound;
+    this->maximumBound = maximumBound;
+
+    return *this;
+}
+Solver & Solver::setThreadCount(size_t threadCount) {
+    this->threadCount = threadCount;
+
+    arena.terminate();
+    arena.initialize(threadCount ? (int)threadCount : tbb::task_arena::automatic);
+
+    return *this;
+}
+
+Solver & Solver::setSorting(bool enabled) {
+    this->sorting = enabled;
+    return *this;
+}
+
+Solver & Solver::setScatterStrategy(ScatterStrategy scatterStrategy) {
+    this->scatterStrategy = scatterStrategy;
+    return *this;
+}
+Solver & Solver::setInterpolation(Interpolation interpolation) {
+    this->interpolation = interpolation;
+    return *this;
+}
+Solver & Solver::setDimension(int dimension) {
+    this->dimension = dimension == 2 ? 2 : 3;
+    return *this;
+}
+Solver & Solver::setConstitutiveModel(ConstitutiveModel constitutiveModel) {
+    this->constitutiveModel = constitutiveModel;
+    return *this;
+}
+Solver & Solver::setCflNumber(float cflNumber) {
+    this->cflNumber = cflNumber;
+    return *this;
+}
+Solver & Solver::setTimeStepBounds(float minimumTimeStep, float maximumTimeStep) {
+    this->minimumTimeStep = minimumTimeStep;
+    this->maximumTimeStep = maximumTimeStep;
+
+    return *this;
+}
+Solver & Solver::setMaximumSubsteps(size_t maximumSubsteps) {
+    this->maximumSubsteps = maximumSubsteps;
+    return *this;
+}
+Solver & Solver::setIntegration(Integration integration) {
+    this->integration = integration;
+    return *this;
+}
+Solver & Solver::setNewtonIterations(size_t newtonIterations) {
+    this->newtonIterations = newtonIterations;
+    return *this;
+}
+Solver & Solver::setKrylovIterations(size_t krylovIterations) {
+    this->krylovIterations = krylovIterations;
+    return *this;
+}
+Solver & Solver::setNewtonTolerance(float newtonTolerance) {
+    this->newtonTolerance = newtonTolerance;
+    return *this;
+}
+Solver & Solver::setKrylovTolerance(float krylovTolerance) {
+    this->krylovTolerance = krylovTolerance;
+    return *this;
+}
+Solver & Solver::setPreconditioner(Preconditioner preconditioner) {
+    this->preconditioner = preconditioner;
+    return *this;
+}
+
+float Solver::getGridSpacing() const {
+    return gridSpacing;
+}
+float Solver::getTimeStep() const {
+    return timeStep;
+}
+const glm::vec3 & Solver::getGravity() const {
+    return gravity;
+}
+const glm::vec3 & Solver::getMinimumBound() const {
+    return minimumBound;
+}
+const glm::vec3 & Solver::getMaximumBound() const {
+    return maximumBound;
+}
+size_t Solver::getThreadCount() const {
+    return threadCount;
+}
+bool Solver::getSorting() const {
+    return sorting;
+}
+ScatterStrategy Solver::getScatterStrategy() const {
+    return scatterStrategy;
+}
+Interpolation Solver::getInterpolation() const {
+    return interpolation;
+}
+int Solver::getDimension() const {
+    return dimension;
+}
+ConstitutiveModel Solver::getConstitutiveModel() const {
+    return constitutiveModel;
+}
+float Solver::getCflNumber() const {
+    return cflNumber;
+}
+float Solver::getMinimumTimeStep() const {
+    return minimumTimeStep;
+}
+float Solver::getMaximumTimeStep() const {
+    return maximumTimeStep;
+}
+size_t Solver::getMaximumSubsteps() const {
+    return maximumSubsteps;
+}
+size_t Solver::getSubstepCount() const {
+    return substepCount;
+}
+float Solver::getMaximumSpeed() const {
+    return maximumSpeed;
+}
+float Solver::getMaximumWaveSpeed() const {
+    return maximumWaveSpeed;
+}
+Integration Solver::getIntegration() const {
+    return integration;
+}
+size_t Solver::getNewtonIterations() const {
+    return newtonIterations;
+}
+size_t Solver::getKrylovIterations() const {
+    return krylovIterations;
+}
+float Solver::getNewtonTolerance() const {
+    return newtonTolerance;
+}
+float Solver::getKrylovTolerance() const {
+    return krylovTolerance;
+}
+Preconditioner Solver::getPreconditioner() const {
+    return preconditioner;
+}
+size_t Solver::getNewtonIterationCount() const {
+    return newtonIterationCount;
+}
+size_t Solver::getKrylovIterationCount() const {
+    return krylovIterationCount;
+}
+
+ParticleSystem & Solver::getParticles() {
+    return particles;
+}
+const ParticleSystem & Solver::getParticles() const {
+    return particles;
+}
+const Grid & Solver::getGrid() const {
+    return grid;
+}
+Collider & Solver::getCollider(size_t i) {
+    return colliders[i];
+}
+const std::vector<Collider> & Solver::getColliders() const {
+    return colliders;
+}
+size_t Solver::getColliderCount() const {
+    return colliders.size();
+}
+size_t Solver::getParticleCount() const {
+    return particles.getParticleCount();
+}
+
+MPM_NAMESPACE_END
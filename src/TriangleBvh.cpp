@@ -0,0 +1,680 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <mpm/TriangleBvh.h>
+
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
+
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_invoke.h>
+#include <tbb/parallel_sort.h>
+#include <tbb/blocked_range.h>
+
+#include <algorithm>
+#include <functional>
+#include <cmath>
+#include <limits>
+
+MPM_NAMESPACE_BEGIN
+
+static const uint32_t INVALID_TRIANGLE = std::numeric_limits<uint32_t>::max();
+static const uint32_t INVALID_NODE = std::numeric_limits<uint32_t>::max();
+static const size_t PARALLEL_BUILD_SIZE = 4096;
+static const size_t STACK_SIZE = 128;
+static const glm::vec3 PARITY_DIRECTIONS[3] = {
+    glm::vec3(0.8628f, 0.4316f, 0.2634f),
+    glm::vec3(-0.3146f, 0.8533f, 0.4157f),
+    glm::vec3(0.2419f, -0.5237f, 0.8167f)
+};
+
+class RayFrame {
+public:
+    glm::vec3 origin;
+    glm::vec3 direction;
+    int x;
+    int y;
+    int z;
+    float shearX;
+    float shearY;
+    float shearZ;
+
+    RayFrame(const glm::vec3 & origin, const glm::vec3 & direction) {
+        this->origin = origin;
+        this->direction = direction;
+
+        glm::vec3 magnitude = glm::abs(direction);
+        z = magnitude.x > magnitude.y ? (magnitude.x > magnitude.z ? 0 : 2) : (magnitude.y > magnitude.z ? 1 : 2);
+        x = (z + 1) % 3;
+        y = (x + 1) % 3;
+
+        if (direction[z] < 0.0f)
+            std::swap(x, y);
+
+        shearX = direction[x] / direction[z];
+        shearY = direction[y] / direction[z];
+        shearZ = 1.0f / direction[z];
+    }
+};
+
+static void getCorners(const TriangleMesh & mesh, size_t index, TriangleBvh::Triangle & triangle) {
+    size_t v0, v1, v2;
+    mesh.getVertexIndices(index, v0, v1, v2);
+
+    triangle.a = mesh.getTransformedVertex(v0);
+    triangle.b = mesh.getTransformedVertex(v1);
+    triangle.c = mesh.getTransformedVertex(v2);
+}
+static void getCorners(
+    const CompactTriangleMesh & mesh, size_t index, TriangleBvh::Triangle & triangle) {
+    uint32_t v0, v1, v2;
+    mesh.getIndices(index, v0, v1, v2);
+
+    triangle.a = mesh.getVertex(v0).position;
+    triangle.b = mesh.getVertex(v1).position;
+    triangle.c = mesh.getVertex(v2).position;
+}
+static uint32_t spreadBits(uint32_t value) {
+    value = (value | value << 16) & 0x030000ff;
+    value = (value | value << 8) & 0x0300f00f;
+    value = (value | value << 4) & 0x030c30c3;
+    value = (value | value << 2) & 0x09249249;
+
+    return value;
+}
+static uint32_t getMortonCode(const glm::vec3 & position) {
+    glm::vec3 cell = glm::clamp(position * 1024.0f, glm::vec3(0.0f), glm::vec3(1023.0f));
+
+    return spreadBits((uint32_t)cell.x) << 2 | spreadBits((uint32_t)cell.y) << 1 | spreadBits((uint32_t)cell.z);
+}
+static size_t findSplit(const std::vector<uint32_t> & codes, size_t first, size_t last) {
+    uint32_t difference = codes[first] ^ codes[last - 1];
+
+    if (difference == 0)
+        return (first + last) / 2;
+
+    uint32_t highBit = 1u << 31;
+
+    while (!(difference & highBit))
+        highBit >>= 1;
+
+    size_t low = first;
+    size_t high = last - 1;
+
+    while (low + 1 < high) {
+        size_t middle = (low + high) / 2;
+
+        if ((codes[middle] ^ codes[first]) < highBit)
+            low = middle;
+        else
+            high = middle;
+    }
+
+    return high;
+}
+
+static float getBoxDistance(const TriangleBvh::Node & node, const glm::vec3 & point) {
+    glm::vec3 offset = glm::max(glm::max(node.lower - point, point - node.upper), glm::vec3(0.0f));
+
+    return glm::dot(offset, offset);
+}
+static bool intersectsBox(const TriangleBvh::Node & node, const RayFrame & ray) {
+    float start = 0.0f;
+    float end = std::numeric_limits<float>::max();
+
+    for (int axis = 0; axis < 3; axis++) {
+        if (ray.direction[axis] == 0.0f) {
+            if (ray.origin[axis] < node.lower[axis] || ray.origin[axis] > node.upper[axis])
+                return false;
+
+            continue;
+        }
+
+        float inverse = 1.0f / ray.direction[axis];
+        float t0 = (node.lower[axis] - ray.origin[axis]) * inverse;
+        float t1 = (node.upper[axis] - ray.origin[axis]) * inverse;
+
+        if (t0 > t1)
+            std::swap(t0, t1);
+
+        start = std::max(start, t0);
+        end = std::min(end, t1 * (1.0f + 4.0f * std::numeric_limits<float>::epsilon()));
+
+        if (start > end)
+            return false;
+    }
+
+    return true;
+}
+static bool ownsEdge(double x, double y) {
+    return y > 0.0 || (y == 0.0 && x > 0.0);
+}
+static bool intersectTriangle(const TriangleBvh::Triangle & triangle, const RayFrame & ray, float & t) {
+    glm::vec3 a = triangle.a - ray.origin;
+    glm::vec3 b = triangle.b - ray.origin;
+    glm::vec3 c = triangle.c - ray.origin;
+
+    float ax = a[ray.x] - ray.shearX * a[ray.z];
+    float ay = a[ray.y] - ray.shearY * a[ray.z];
+    float bx = b[ray.x] - ray.shearX * b[ray.z];
+    float by = b[ray.y] - ray.shearY * b[ray.z];
+    float cx = c[ray.x] - ray.shearX * c[ray.z];
+    float cy = c[ray.y] - ray.shearY * c[ray.z];
+
+    double u = cx * by - cy * bx;
+    double v = ax * cy - ay * cx;
+    double w = bx * ay - by * ax;
+
+    if (u == 0.0 || v == 0.0 || w == 0.0) {
+        u = (double)cx * by - (double)cy * bx;
+        v = (double)ax * cy - (double)ay * cx;
+        w = (double)bx * ay - (double)by * ax;
+    }
+
+    double determinant = u + v + w;
+
+    if (determinant == 0.0)
+        return false;
+
+    double sign = determinant < 0.0 ? -1.0 : 1.0;
+    u *= sign;
+    v *= sign;
+    w *= sign;
+
+    // Points on a shared edge belong to exactly one of its triangles, so
+    // parity counts stay correct along rays that graze the mesh.
+    if (u < 0.0 || (u == 0.0 && !ownsEdge(sign * (cx - bx), sign * (cy - by))))
+        return false;
+
+    if (v < 0.0 || (v == 0.0 && !ownsEdge(sign * (ax - cx), sign * (ay - cy))))
+        return false;
+
+    if (w < 0.0 || (w == 0.0 && !ownsEdge(sign * (bx - ax), sign * (by - ay))))
+        return false;
+
+    double distance = ray.shearZ * (u * a[ray.z] + v * b[ray.z] + w * c[ray.z]) / (sign * determinant);
+
+    if (distance <= 0.0)
+        return false;
+
+    t = (float)distance;
+
+    return true;
+}
+static glm::vec3 getClosestTrianglePoint(const TriangleBvh::Triangle & triangle, const glm::vec3 & point) {
+    glm::vec3 ab = triangle.b - triangle.a;
+    glm::vec3 ac = triangle.c - triangle.a;
+    glm::vec3 ap = point - triangle.a;
+
+    float d1 = glm::dot(ab, ap);
+    float d2 = glm::dot(ac, ap);
+
+    if (d1 <= 0.0f && d2 <= 0.0f)
+        return triangle.a;
+
+    glm::vec3 bp = point - triangle.b;
+    float d3 = glm::dot(ab, bp);
+    float d4 = glm::dot(ac, bp);
+
+    if (d3 >= 0.0f && d4 <= d3)
+        return triangle.b;
+
+    float vc = d1 * d4 - d3 * d2;
+
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+        return triangle.a + ab * (d1 / (d1 - d3));
+
+    glm::vec3 cp = point - triangle.c;
+    float d5 = glm::dot(ab, cp);
+    float d6 = glm::dot(ac, cp);
+
+    if (d6 >= 0.0f && d5 <= d6)
+        return triangle.c;
+
+    float vb = d5 * d2 - d1 * d6;
+
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+        return triangle.a + ac * (d2 / (d2 - d6));
+
+    float va = d3 * d6 - d5 * d4;
+
+    if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f)
+        return triangle.b + (triangle.c - triangle.b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+    float denominator = 1.0f / (va + vb + vc);
+
+    return triangle.a + ab * (vb * denominator) + ac * (vc * denominator);
+}
+
+TriangleBvh::TriangleBvh() {}
+TriangleBvh::TriangleBvh(const TriangleMesh & mesh) {
+    create(mesh);
+}
+TriangleBvh::TriangleBvh(const CompactTriangleMesh & mesh) {
+    create(mesh);
+}
+TriangleBvh::~TriangleBvh() {}
+
+void TriangleBvh::build(size_t node, size_t first, size_t last, const std::vector<uint32_t> & codes) {
+    Node & current = nodes[node];
+
+    if (last - first == 1) {
+        const Triangle & triangle = triangles[first];
+
+        current.lower = glm::min(glm::min(triangle.a, triangle.b), triangle.c);
+        current.upper = glm::max(glm::max(triangle.a, triangle.b), triangle.c);
+        current.right = 0;
+        current.triangle = (uint32_t)first;
+
+        leaves[triangle.index] = (uint32_t)node;
+
+        return;
+    }
+
+    // Nodes are laid out depth first: the left child follows its parent and
+    // a subtree over n triangles always occupies 2n - 1 nodes.
+    size_t split = findSplit(codes, first, last);
+    size_t right = node + 2 * (split - first);
+
+    parents[node + 1] = (uint32_t)node;
+    parents[right] = (uint32_t)node;
+
+    if (last - first > PARALLEL_BUILD_SIZE) {
+        tbb::parallel_invoke(
+            [&]() { build(node + 1, first, split, codes); },
+            [&]() { build(right, split, last, codes); });
+    } else {
+        build(node + 1, first, split, codes);
+        build(right, split, last, codes);
+    }
+
+    current.lower = glm::min(nodes[node + 1].lower, nodes[right].lower);
+    current.upper = glm::max(nodes[node + 1].upper, nodes[right].upper);
+    current.right = (uint32_t)right;
+    current.triangle = INVALID_TRIANGLE;
+}
+void TriangleBvh::refit(size_t node) {
+    Node & current = nodes[node];
+
+    if (current.triangle != INVALID_TRIANGLE) {
+        const Triangle & triangle = triangles[current.triangle];
+
+        current.lower = glm::min(glm::min(triangle.a, triangle.b), triangle.c);
+        current.upper = glm::max(glm::max(triangle.a, triangle.b), triangle.c);
+
+        return;
+    }
+
+    if (current.right - node > PARALLEL_BUILD_SIZE) {
+        tbb::parallel_invoke(
+            [&]() { refit(node + 1); },
+            [&]() { refit(current.right); });
+    } else {
+        refit(node + 1);
+        refit(current.right);
+    }
+
+    current.lower = glm::min(nodes[node + 1].lower, nodes[current.right].lower);
+    current.upper = glm::max(nodes[node + 1].upper, nodes[current.right].upper);
+}
+
+template <typename T>
+TriangleBvh & TriangleBvh::createFrom(const T & mesh) {
+    clear();
+
+    size_t triangleCount = mesh.getTriangleCount();
+
+    if (triangleCount == 0 || triangleCount > std::numeric_limits<uint32_t>::max() / 2)
+        return *this;
+
+    std::vector<Triangle> unsorted(triangleCount);
+    std::vector<glm::vec3> centroids(triangleCount);
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, triangleCount),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t i = range.begin(); i < range.end(); i++) {
+            Triangle & triangle = unsorted[i];
+            getCorners(mesh, i, triangle);
+            triangle.index = (uint32_t)i;
+
+            centroids[i] = (triangle.a + triangle.b + triangle.c) / 3.0f;
+        }
+    });
+
+    glm::vec3 lower = centroids[0];
+    glm::vec3 upper = centroids[0];
+
+    for (const glm::vec3 & centroid : centroids) {
+        lower = glm::min(lower, centroid);
+        upper = glm::max(upper, centroid);
+    }
+
+    glm::vec3 extent = upper - lower;
+    glm::vec3 scale(
+        extent.x > 0.0f ? 1.0f / extent.x : 0.0f,
+        extent.y > 0.0f ? 1.0f / extent.y : 0.0f,
+        extent.z > 0.0f ? 1.0f / extent.z : 0.0f);
+
+    std::vector<uint64_t> keys(triangleCount);
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, triangleCount),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t i = range.begin(); i < range.end(); i++)
+            keys[i] = (uint64_t)getMortonCode((centroids[i] - lower) * scale) << 32 | i;
+    });
+
+    std::vector<glm::vec3>().swap(centroids);
+    tbb::parallel_sort(keys.begin(), keys.end());
+
+    std::vector<uint32_t> codes(triangleCount);
+    triangles.resize(triangleCount);
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, triangleCount),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t i = range.begin(); i < range.end(); i++) {
+            codes[i] = (uint32_t)(keys[i] >> 32);
+            triangles[i] = unsorted[keys[i] & 0xffffffff];
+        }
+    });
+
+    nodes.resize(2 * triangleCount - 1);
+    parents.resize(nodes.size());
+    leaves.resize(triangleCount);
+    marks.assign(nodes.size(), 0);
+
+    parents[0] = INVALID_NODE;
+    build(0, 0, triangleCount, codes);
+
+    return *this;
+}
+template <typename T>
+TriangleBvh & TriangleBvh::refitFrom(const T & mesh) {
+    if (empty() || mesh.getTriangleCount() != triangles.size())
+        return createFrom(mesh);
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, triangles.size()),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t i = range.begin(); i < range.end(); i++)
+            getCorners(mesh, triangles[i].index, triangles[i]);
+    });
+
+    refit(0);
+
+    return *this;
+}
+template <typename T>
+TriangleBvh & TriangleBvh::refitFrom(const T & mesh, const std::vector<uint32_t> & dirty) {
+    if (empty() || mesh.getTriangleCount() != triangles.size())
+        return createFrom(mesh);
+
+    std::vector<uint32_t> ancestors;
+
+    for (uint32_t index : dirty) {
+        Node & leaf = nodes[leaves[index]];
+        Triangle & triangle = triangles[leaf.triangle];
+        getCorners(mesh, index, triangle);
+
+        leaf.lower = glm::min(glm::min(triangle.a, triangle.b), triangle.c);
+        leaf.upper = glm::max(glm::max(triangle.a, triangle.b), triangle.c);
+
+        for (uint32_t node = parents[leaves[index]]; node != INVALID_NODE && !marks[node];
+            node = parents[node]) {
+            marks[node] = 1;
+            ancestors.push_back(node);
+        }
+    }
+
+    // Children always follow their parent, so refitting in decreasing order
+    // visits every subtree before the nodes above it.
+    std::sort(ancestors.begin(), ancestors.end(), std::greater<uint32_t>());
+
+    for (uint32_t node : ancestors) {
+        Node & current = nodes[node];
+
+        current.lower = glm::min(nodes[node + 1].lower, nodes[current.right].lower);
+        current.upper = glm::max(nodes[node + 1].upper, nodes[current.right].upper);
+
+        marks[node] = 0;
+    }
+
+    return *this;
+}
+
+TriangleBvh & TriangleBvh::create(const TriangleMesh & mesh) {
+    return createFrom(mesh);
+}
+TriangleBvh & TriangleBvh::create(const CompactTriangleMesh & mesh) {
+    return createFrom(mesh);
+}
+TriangleBvh & TriangleBvh::refit(const TriangleMesh & mesh) {
+    return refitFrom(mesh);
+}
+TriangleBvh & TriangleBvh::refit(const CompactTriangleMesh & mesh) {
+    return refitFrom(mesh);
+}
+TriangleBvh & TriangleBvh::refit(const TriangleMesh & mesh, const std::vector<uint32_t> & dirty) {
+    return refitFrom(mesh, dirty);
+}
+TriangleBvh & TriangleBvh::refit(
+    const CompactTriangleMesh & mesh, const std::vector<uint32_t> & dirty) {
+    return refitFrom(mesh, dirty);
+}
+TriangleBvh & TriangleBvh::clear() {
+    std::vector<Node>().swap(nodes);
+    std::vector<Triangle>().swap(triangles);
+    std::vector<uint32_t>().swap(parents);
+    std::vector<uint32_t>().swap(leaves);
+    std::vector<uint8_t>().swap(marks);
+
+    return *this;
+}
+
+float TriangleBvh::getClosestPoint(const glm::vec3 & point, glm::vec3 & closest, size_t & triangle) const {
+    float best = std::numeric_limits<float>::infinity();
+
+    if (empty())
+        return best;
+
+    uint32_t stack[STACK_SIZE];
+    size_t size = 0;
+    stack[size++] = 0;
+
+    while (size > 0) {
+        uint32_t index = stack[--size];
+        const Node & node = nodes[index];
+
+        if (getBoxDistance(node, point) >= best)
+            continue;
+
+        if (node.triangle != INVALID_TRIANGLE) {
+            const Triangle & candidate = triangles[node.triangle];
+            glm::vec3 position = getClosestTrianglePoint(candidate, point);
+            glm::vec3 offset = position - point;
+            float distance = glm::dot(offset, offset);
+
+            if (distance < best) {
+                best = distance;
+                closest = position;
+                triangle = candidate.index;
+            }
+
+            continue;
+        }
+
+        uint32_t first = index + 1;
+        uint32_t second = node.right;
+        float firstDistance = getBoxDistance(nodes[first], point);
+        float secondDistance = getBoxDistance(nodes[second], point);
+
+        if (secondDistance < firstDistance) {
+            std::swap(first, second);
+            std::swap(firstDistance, secondDistance);
+        }
+
+        if (secondDistance < best)
+            stack[size++] = second;
+
+        if (firstDistance < best)
+            stack[size++] = first;
+    }
+
+    return std::sqrt(best);
+}
+size_t TriangleBvh::countIntersections(const glm::vec3 & origin, const glm::vec3 & direction) const {
+    if (empty())
+        return 0;
+
+    RayFrame ray(origin, direction);
+    size_t count = 0;
+
+    uint32_t stack[STACK_SIZE];
+    size_t size = 0;
+    stack[size++] = 0;
+
+    while (size > 0) {
+        uint32_t index = stack[--size];
+        const Node & node = nodes[index];
+
+        if (!intersectsBox(node, ray))
+            continue;
+
+        if (node.triangle != INVALID_TRIANGLE) {
+            float t;
+
+            if (intersectTriangle(triangles[node.triangle], ray, t))
+                count++;
+
+            continue;
+        }
+
+        stack[size++] = node.right;
+        stack[size++] = index + 1;
+    }
+
+    return count;
+}
+void TriangleBvh::getIntersections(
+    const glm::vec3 & origin, const glm::vec3 & direction, std::vector<float> & distances) const {
+    distances.clear();
+
+    if (empty())
+        return;
+
+    RayFrame ray(origin, direction);
+
+    uint32_t stack[STACK_SIZE];
+    size_t size = 0;
+    stack[size++] = 0;
+
+    while (size > 0) {
+        uint32_t index = stack[--size];
+        const Node & node = nodes[index];
+
+        if (!intersectsBox(node, ray))
+            continue;
+
+        if (node.triangle != INVALID_TRIANGLE) {
+            float t;
+
+            if (intersectTriangle(triangles[node.triangle], ray, t))
+                distances.push_back(t);
+
+            continue;
+        }
+
+        stack[size++] = node.right;
+        stack[size++] = index + 1;
+    }
+
+    std::sort(distances.begin(), distances.end());
+}
+bool TriangleBvh::isInside(const glm::vec3 & point) const {
+    int votes = 0;
+
+    for (const glm::vec3 & direction : PARITY_DIRECTIONS)
+        votes += countIntersections(point, direction) & 1;
+
+    return votes >= 2;
+}
+float TriangleBvh::getSignedDistance(const glm::vec3 & point) const {
+    glm::vec3 closest;
+    size_t triangle;
+
+    float distance = getClosestPoint(point, closest, triangle);
+
+    return isInside(point) ? -distance : distance;
+}
+
+void TriangleBvh::getClosestPoints(
+    Span<const glm::vec3> points, Span<glm::vec3> closest, Span<float> distances) const {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, points.size()),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t i = range.begin(); i < range.end(); i++) {
+            size_t triangle;
+            distances[i] = getClosestPoint(points[i], closest[i], triangle);
+        }
+    });
+}
+void TriangleBvh::getSignedDistances(Span<const glm::vec3> points, Span<float> distances) const {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, points.size()),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t i = range.begin(); i < range.end(); i++)
+            distances[i] = getSignedDistance(points[i]);
+    });
+}
+void TriangleBvh::classifyPoints(Span<const glm::vec3> points, Span<uint8_t> inside) const {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, points.size()),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t i = range.begin(); i < range.end(); i++)
+            inside[i] = isInside(points[i]) ? 1 : 0;
+    });
+}
+
+const std::vector<TriangleBvh::Node> & TriangleBvh::getNodes() const {
+    return nodes;
+}
+const std::vector<TriangleBvh::Triangle> & TriangleBvh::getTriangles() const {
+    return triangles;
+}
+void TriangleBvh::getBounds(glm::vec3 & lower, glm::vec3 & upper) const {
+    if (empty()) {
+        lower = glm::vec3(0.0f);
+        upper = glm::vec3(0.0f);
+        return;
+    }
+
+    lower = nodes[0].lower;
+    upper = nodes[0].upper;
+}
+size_t TriangleBvh::getTriangleCount() const {
+    return triangles.size();
+}
+bool TriangleBvh::empty() const {
+    return nodes.empty();
+}
+
+MPM_NAMESPACE_END
@@ -27,93 +27,678 @@
 
 #include <mpm/TriangleMesh.h>
 
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+
 #include <fstream>
 #include <sstream>
+#include <iomanip>
+#include <random>
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 MPM_NAMESPACE_BEGIN
 
-TriangleMesh * TriangleMesh::loadMesh(const std::string & filename) {
-    std::ifstream file(filename, std::ifstream::in);
+static const size_t CHUNK_SIZE = 1 << 20;
+static const size_t TRANSFORM_BATCH_SIZE = 64;
+static const size_t BLOCK_ALIGNMENT = 64;
+static const char BINARY_MAGIC[8] = {'M', 'P', 'M', 'M', 'E', 'S', 'H', 0};
+static const uint32_t BINARY_VERSION = 1;
+static const char * BINARY_EXTENSION = ".mesh";
 
-    if (!file.is_open())
-        return nullptr;
+class MeshHeader {
+public:
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t counts[6];
+    uint64_t sourceSize;
+    int64_t sourceTime;
+};
+
+class MappedFile {
+private:
+#if defined(_WIN32)
+    HANDLE file;
+    HANDLE mapping;
+#else
+    int descriptor;
+#endif
+    const char * data;
+    size_t size;
+    bool opened;
+
+public:
+    MappedFile(const std::string & filename) : data(nullptr), size(0), opened(false) {
+#if defined(_WIN32)
+        mapping = nullptr;
+        file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+            OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+        if (file == INVALID_HANDLE_VALUE)
+            return;
+
+        LARGE_INTEGER fileSize;
+
+        if (!GetFileSizeEx(file, &fileSize))
+            return;
+
+        size = (size_t)fileSize.QuadPart;
+        opened = true;
+
+        if (size == 0)
+            return;
+
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+        if (mapping)
+            data = static_cast<const char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+        descriptor = open(filename.c_str(), O_RDONLY);
+
+        if (descriptor < 0)
+            return;
+
+        struct stat status;
+
+        if (fstat(descriptor, &status) != 0)
+            return;
+
+        size = (size_t)status.st_size;
+        opened = true;
+
+        if (size == 0)
+            return;
+
+        void * pointer = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+        if (pointer != MAP_FAILED) {
+            data = static_cast<const char *>(pointer);
+            madvise(pointer, size, MADV_SEQUENTIAL);
+        }
+#endif
+
+        opened = data != nullptr;
+    }
+    ~MappedFile() {
+#if defined(_WIN32)
+        if (data)
+            UnmapViewOfFile(data);
+
+        if (mapping)
+            CloseHandle(mapping);
+
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+#else
+        if (data)
+            munmap(const_cast<char *>(data), size);
+
+        if (descriptor >= 0)
+            close(descriptor);
+#endif
+    }
 
-    std::vector<glm::vec3> vertices, normals;
+    const char * getData() const {
+        return data;
+    }
+    size_t getSize() const {
+        return size;
+    }
+    bool isOpen() const {
+        return opened;
+    }
+};
+
+class MeshChunk {
+public:
+    std::vector<glm::vec3> vertices;
+    std::vector<glm::vec3> normals;
     std::vector<glm::vec2> textureCoordinates;
-    std::vector<size_t> vertexIndices, normalIndices, textureIndices;
+    std::vector<size_t> vertexIndices;
+    std::vector<size_t> normalIndices;
+    std::vector<size_t> textureIndices;
+    std::vector<size_t> relativeVertexIndices;
+    std::vector<size_t> relativeNormalIndices;
+    std::vector<size_t> relativeTextureIndices;
+};
+
+static bool isSpace(char character) {
+    return character == ' ' || character == '\t' || character == '\r';
+}
+static const char * skipSpaces(const char * position, const char * end) {
+    while (position < end && isSpace(*position))
+        position++;
 
-    std::string line;
+    return position;
+}
+static const char * skipLine(const char * position, const char * end) {
+    while (position < end && *position != '\n')
+        position++;
+
+    return position < end ? position + 1 : end;
+}
+static const char * parseInteger(const char * position, const char * end, int64_t & value) {
+    const char * start = position;
+    bool negative = false;
+
+    if (position < end && (*position == '-' || *position == '+'))
+        negative = *position++ == '-';
 
-    while (std::getline(file, line)) {
-        std::istringstream attributes(line);
+    const char * digits = position;
+    int64_t result = 0;
 
-        std::string type;
-        attributes >> type;
+    while (position < end && *position >= '0' && *position <= '9')
+        result = result * 10 + (*position++ - '0');
 
-        if (type == "v") {
-            glm::vec3 vertex;
-            attributes >> vertex.x >> vertex.y >> vertex.z;
+    if (position == digits)
+        return start;
+
+    value = negative ? -result : result;
+
+    return position;
+}
+static const char * parseFloat(const char * position, const char * end, float & value) {
+    static const double powers[] = {
+        1.0e0, 1.0e1, 1.0e2, 1.0e3, 1.0e4, 1.0e5, 1.0e6, 1.0e7, 1.0e8, 1.0e9, 1.0e10, 1.0e11,
+        1.0e12, 1.0e13, 1.0e14, 1.0e15, 1.0e16, 1.0e17, 1.0e18, 1.0e19, 1.0e20, 1.0e21, 1.0e22
+    };
 
-            vertices.push_back(vertex);
+    const char * start = position;
+    bool negative = false;
+
+    if (position < end && (*position == '-' || *position == '+'))
+        negative = *position++ == '-';
+
+    uint64_t mantissa = 0;
+    int digitCount = 0;
+    int exponent = 0;
+    bool parsed = false;
+
+    for (; position < end && *position >= '0' && *position <= '9'; position++, parsed = true) {
+        if (digitCount < 19) {
+            mantissa = mantissa * 10 + (*position - '0');
+            digitCount += mantissa > 0;
+        }
+        else {
+            exponent++;
         }
-        else if (type == "vt") {
-            glm::vec2 uvCoordinates;
-            attributes >> uvCoordinates.x >> uvCoordinates.y;
+    }
 
-            textureCoordinates.push_back(uvCoordinates);
+    if (position < end && *position == '.') {
+        for (position++; position < end && *position >= '0' && *position <= '9';
+            position++, parsed = true) {
+            if (digitCount < 19) {
+                mantissa = mantissa * 10 + (*position - '0');
+                digitCount += mantissa > 0;
+                exponent--;
+            }
         }
-        else if (type == "vn") {
-            glm::vec3 normal;
-            attributes >> normal.x >> normal.y >> normal.z;
+    }
+
+    if (!parsed)
+        return start;
+
+    if (position < end && (*position == 'e' || *position == 'E')) {
+        int64_t power;
+        const char * next = parseInteger(position + 1, end, power);
+
+        if (next != position + 1) {
+            exponent += (int)std::max<int64_t>(std::min<int64_t>(power, 1000), -1000);
+            position = next;
+        }
+    }
+
+    double result = (double)mantissa;
 
-            normals.push_back(normal);
+    if (exponent >= 0 && exponent <= 22)
+        result *= powers[exponent];
+    else if (exponent < 0 && exponent >= -22)
+        result /= powers[-exponent];
+    else
+        result *= std::pow(10.0, exponent);
+
+    value = (float)(negative ? -result : result);
+
+    return position;
+}
+template <int size, typename Vector>
+static const char * parseVector(const char * position, const char * end, Vector & vector) {
+    for (int i = 0; i < size; i++)
+        position = parseFloat(skipSpaces(position, end), end, vector[i]);
+
+    return position;
+}
+static void pushIndex(
+    int64_t index, size_t count, std::vector<size_t> & indices, std::vector<size_t> & relatives) {
+    if (index < 0) {
+        relatives.push_back(indices.size());
+        indices.push_back(count + (size_t)index);
+    }
+    else {
+        indices.push_back((size_t)index - 1);
+    }
+}
+static const char * parseCorner(
+    const char * position, const char * end, int64_t (&corner)[3], bool (&present)[3]) {
+    present[0] = present[1] = present[2] = false;
+
+    for (int i = 0; i < 3; i++) {
+        if (i > 0) {
+            if (position == end || *position != '/')
+                break;
+
+            position++;
         }
-        else if (type == "f") {
-            for (size_t i = 0; i < 3; i++) {
-                std::string tokens;
-                attributes >> tokens;
 
-                std::replace(tokens.begin(), tokens.end(), '/', ' ');
+        const char * next = parseInteger(position, end, corner[i]);
+        present[i] = next != position;
+        position = next;
+    }
+
+    return position;
+}
+static void parseFace(const char * position, const char * end, MeshChunk & chunk) {
+    int64_t corners[3][3];
+    bool present[3][3];
+    int cornerCount = 0;
+
+    while (true) {
+        position = skipSpaces(position, end);
 
-                std::istringstream indices(tokens);
-                size_t index;
+        if (position == end || *position == '\n' || *position == '#')
+            break;
 
-                indices >> index;
-                vertexIndices.push_back(index - 1);
+        int slot = cornerCount < 3 ? cornerCount : 2;
+        const char * next = parseCorner(position, end, corners[slot], present[slot]);
 
-                if (indices.peek() == ' ') {
-                    indices.ignore();
+        if (next == position || !present[slot][0])
+            break;
 
-                    if (indices.peek() == ' ') {
-                        indices.ignore();
+        position = next;
+        cornerCount++;
 
-                        indices >> index;
-                        normalIndices.push_back(index - 1);
-                    }
-                    else {
-                        indices >> index;
-                        textureIndices.push_back(index - 1);
+        if (cornerCount < 3)
+            continue;
 
-                        if (indices.peek() == ' ') {
-                            indices.ignore();
+        std::vector<size_t> * arrays[3] = {
+            &chunk.vertexIndices, &chunk.textureIndices, &chunk.normalIndices};
+        std::vector<size_t> * relatives[3] = {
+            &chunk.relativeVertexIndices, &chunk.relativeTextureIndices,
+            &chunk.relativeNormalIndices};
+        size_t counts[3] = {
+            chunk.vertices.size(), chunk.textureCoordinates.size(), chunk.normals.size()};
 
-                            indices >> index;
-                            normalIndices.push_back(index - 1);
-                        }
-                    }
+        for (int attribute = 0; attribute < 3; attribute++) {
+            for (int corner = 0; corner < 3; corner++) {
+                if (present[corner][attribute]) {
+                    pushIndex(corners[corner][attribute], counts[attribute],
+                        *arrays[attribute], *relatives[attribute]);
                 }
             }
         }
+
+        for (int attribute = 0; attribute < 3; attribute++) {
+            corners[1][attribute] = corners[2][attribute];
+            present[1][attribute] = present[2][attribute];
+        }
     }
+}
+static void parseChunk(const char * position, const char * end, MeshChunk & chunk) {
+    while (position < end) {
+        position = skipSpaces(position, end);
 
-    file.close();
+        if (position + 1 < end && position[0] == 'v' && isSpace(position[1])) {
+            glm::vec3 vertex(0);
+            parseVector<3>(position + 2, end, vertex);
+            chunk.vertices.push_back(vertex);
+        }
+        else if (position + 2 < end && position[0] == 'v' && position[1] == 't'
+            && isSpace(position[2])) {
+            glm::vec2 textureCoordinates(0);
+            parseVector<2>(position + 3, end, textureCoordinates);
+            chunk.textureCoordinates.push_back(textureCoordinates);
+        }
+        else if (position + 2 < end && position[0] == 'v' && position[1] == 'n'
+            && isSpace(position[2])) {
+            glm::vec3 normal(0);
+            parseVector<3>(position + 3, end, normal);
+            chunk.normals.push_back(normal);
+        }
+        else if (position + 1 < end && position[0] == 'f' && isSpace(position[1])) {
+            parseFace(position + 2, end, chunk);
+        }
 
-    return new TriangleMesh(vertices, normals, textureCoordinates,
-        vertexIndices, normalIndices, textureIndices);
+        position = skipLine(position, end);
+    }
+}
+template <typename T>
+static std::vector<size_t> mergeChunks(
+    std::vector<MeshChunk> & chunks, std::vector<T> MeshChunk::*values, std::vector<T> & result) {
+    std::vector<size_t> starts(chunks.size() + 1, 0);
+
+    for (size_t i = 0; i < chunks.size(); i++)
+        starts[i + 1] = starts[i] + (chunks[i].*values).size();
+
+    result.resize(starts.back());
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, chunks.size()),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t i = range.begin(); i < range.end(); i++) {
+            std::vector<T> & chunkValues = chunks[i].*values;
+            std::copy(chunkValues.begin(), chunkValues.end(), result.begin() + starts[i]);
+            std::vector<T>().swap(chunkValues);
+        }
+    });
+
+    return starts;
+}
+static void mergeIndices(
+    std::vector<MeshChunk> & chunks, std::vector<size_t> MeshChunk::*indices,
+    std::vector<size_t> MeshChunk::*relatives, const std::vector<size_t> & offsets,
+    std::vector<size_t> & result) {
+    std::vector<size_t> starts = mergeChunks(chunks, indices, result);
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, chunks.size()),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t i = range.begin(); i < range.end(); i++) {
+            for (size_t relative : chunks[i].*relatives)
+                result[starts[i] + relative] += offsets[i];
+        }
+    });
+}
+static bool getFileStamp(const std::string & filename, uint64_t & size, int64_t & time) {
+    struct stat status;
+
+    if (stat(filename.c_str(), &status) != 0)
+        return false;
+
+    size = (uint64_t)status.st_size;
+    time = (int64_t)status.st_mtime;
+
+    return true;
 }
+static std::string getCachePath(const std::string & directory, const std::string & filename) {
+    uint64_t hash = 0xcbf29ce484222325;
+
+    for (char c : filename)
+        hash = (hash ^ (unsigned char)c) * 0x100000001b3;
 
-TriangleMesh::TriangleMesh() {}
+    std::ostringstream path;
+    path << directory << '/' << std::hex << std::setw(16) << std::setfill('0') << hash
+        << BINARY_EXTENSION;
+
+    return path.str();
+}
+static size_t align(size_t offset) {
+    return (offset + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT * BLOCK_ALIGNMENT;
+}
+static size_t getHeaderSize() {
+    return align(sizeof(MeshHeader));
+}
+static bool getBlockOffsets(
+    const uint64_t (&counts)[6], uint64_t (&offsets)[7], uint64_t size) {
+    const size_t sizes[6] = {
+        sizeof(glm::vec3), sizeof(glm::vec3), sizeof(glm::vec2),
+        sizeof(uint64_t), sizeof(uint64_t), sizeof(uint64_t)};
+
+    offsets[0] = getHeaderSize();
+
+    for (int i = 0; i < 6; i++) {
+        if (offsets[i] > size || counts[i] > (size - offsets[i]) / sizes[i])
+            return false;
+
+        offsets[i + 1] = align(offsets[i] + counts[i] * sizes[i]);
+    }
+
+    return offsets[6] <= size;
+}
+static bool isBinaryMesh(const char * data, size_t size) {
+    return size >= sizeof(MeshHeader) && std::memcmp(data, BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0;
+}
+static bool isSourceCurrent(
+    const char * data, size_t size, uint64_t sourceSize, int64_t sourceTime) {
+    MeshHeader header;
+
+    if (!isBinaryMesh(data, size))
+        return false;
+
+    std::memcpy(&header, data, sizeof(MeshHeader));
+
+    return header.sourceSize == sourceSize && header.sourceTime == sourceTime;
+}
+template <typename T>
+static void readBlock(const char * data, uint64_t count, std::vector<T> & values) {
+    values.resize(count);
+    std::memcpy(values.data(), data, count * sizeof(T));
+}
+static void readIndices(const char * data, uint64_t count, std::vector<size_t> & indices) {
+    indices.resize(count);
+
+    if (sizeof(size_t) == sizeof(uint64_t)) {
+        std::memcpy(indices.data(), data, count * sizeof(uint64_t));
+        return;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        uint64_t index;
+        std::memcpy(&index, data + i * sizeof(uint64_t), sizeof(uint64_t));
+        indices[i] = (size_t)index;
+    }
+}
+static void writePadding(std::ofstream & file, uint64_t offset) {
+    static const char zeros[BLOCK_ALIGNMENT] = {};
+    uint64_t position = (uint64_t)file.tellp();
+
+    if (offset > position)
+        file.write(zeros, offset - position);
+}
+template <typename T>
+static void writeBlock(std::ofstream & file, uint64_t offset, const std::vector<T> & values) {
+    writePadding(file, offset);
+    file.write(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(T));
+}
+static void writeIndices(
+    std::ofstream & file, uint64_t offset, const std::vector<size_t> & indices) {
+    writePadding(file, offset);
+
+    if (sizeof(size_t) == sizeof(uint64_t)) {
+        file.write(reinterpret_cast<const char *>(indices.data()),
+            indices.size() * sizeof(uint64_t));
+        return;
+    }
+
+    for (size_t index : indices) {
+        uint64_t value = index;
+        file.write(reinterpret_cast<const char *>(&value), sizeof(uint64_t));
+    }
+}
+static std::vector<size_t> getOffsets(
+    const std::vector<MeshChunk> & chunks, size_t (*count)(const MeshChunk &)) {
+    std::vector<size_t> offsets(chunks.size(), 0);
+
+    for (size_t i = 1; i < chunks.size(); i++)
+        offsets[i] = offsets[i - 1] + count(chunks[i - 1]);
+
+    return offsets;
+}
+
+static void transformBatch(
+    const glm::mat4 & matrix, float w, bool normalize, glm::vec3 * points, size_t count) {
+    alignas(64) float xs[TRANSFORM_BATCH_SIZE];
+    alignas(64) float ys[TRANSFORM_BATCH_SIZE];
+    alignas(64) float zs[TRANSFORM_BATCH_SIZE];
+
+    for (size_t p = 0; p < count; p++) {
+        xs[p] = points[p].x;
+        ys[p] = points[p].y;
+        zs[p] = points[p].z;
+    }
+
+    for (size_t p = count; p < TRANSFORM_BATCH_SIZE; p++) {
+        xs[p] = 1.0f;
+        ys[p] = 0.0f;
+        zs[p] = 0.0f;
+    }
+
+    for (size_t p = 0; p < TRANSFORM_BATCH_SIZE; p++) {
+        float x = matrix[0][0] * xs[p] + matrix[1][0] * ys[p] + matrix[2][0] * zs[p] + matrix[3][0] * w;
+        float y = matrix[0][1] * xs[p] + matrix[1][1] * ys[p] + matrix[2][1] * zs[p] + matrix[3][1] * w;
+        float z = matrix[0][2] * xs[p] + matrix[1][2] * ys[p] + matrix[2][2] * zs[p] + matrix[3][2] * w;
+
+        xs[p] = x;
+        ys[p] = y;
+        zs[p] = z;
+    }
+
+    if (normalize) {
+        for (size_t p = 0; p < TRANSFORM_BATCH_SIZE; p++) {
+            float length = std::sqrt(xs[p] * xs[p] + ys[p] * ys[p] + zs[p] * zs[p]);
+            float scale = length > 0.0f ? 1.0f / length : 0.0f;
+
+            xs[p] *= scale;
+            ys[p] *= scale;
+            zs[p] *= scale;
+        }
+    }
+
+    for (size_t p = 0; p < count; p++)
+        points[p] = glm::vec3(xs[p], ys[p], zs[p]);
+}
+static void transformPoints(
+    const glm::mat4 & matrix, float w, bool normalize, glm::vec3 * points, size_t count) {
+    size_t batchCount = (count + TRANSFORM_BATCH_SIZE - 1) / TRANSFORM_BATCH_SIZE;
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, batchCount),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t i = range.begin(); i < range.end(); i++) {
+            size_t first = i * TRANSFORM_BATCH_SIZE;
+            size_t batchSize = std::min(count - first, TRANSFORM_BATCH_SIZE);
+
+            transformBatch(matrix, w, normalize, points + first, batchSize);
+        }
+    });
+}
+
+
+TriangleMesh * TriangleMesh::loadObj(const char * data, size_t size) {
+    std::vector<size_t> boundaries(1, 0);
+
+    while (boundaries.back() < size) {
+        size_t boundary = std::min(boundaries.back() + CHUNK_SIZE, size);
+        boundary = skipLine(data + boundary - 1, data + size) - data;
+        boundaries.push_back(boundary);
+    }
+
+    std::vector<MeshChunk> chunks(boundaries.size() - 1);
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, chunks.size(), 1),
+        [&](const tbb::blocked_range<size_t> & range) {
+        for (size_t i = range.begin(); i < range.end(); i++)
+            parseChunk(data + boundaries[i], data + boundaries[i + 1], chunks[i]);
+    });
+
+    std::vector<size_t> vertexOffsets = getOffsets(chunks,
+        [](const MeshChunk & chunk) { return chunk.vertices.size(); });
+    std::vector<size_t> normalOffsets = getOffsets(chunks,
+        [](const MeshChunk & chunk) { return chunk.normals.size(); });
+    std::vector<size_t> textureOffsets = getOffsets(chunks,
+        [](const MeshChunk & chunk) { return chunk.textureCoordinates.size(); });
+
+    TriangleMesh * mesh = new TriangleMesh();
+
+    mergeIndices(chunks, &MeshChunk::vertexIndices, &MeshChunk::relativeVertexIndices,
+        vertexOffsets, mesh->vertexIndices);
+    mergeIndices(chunks, &MeshChunk::normalIndices, &MeshChunk::relativeNormalIndices,
+        normalOffsets, mesh->normalIndices);
+    mergeIndices(chunks, &MeshChunk::textureIndices, &MeshChunk::relativeTextureIndices,
+        textureOffsets, mesh->textureIndices);
+    mergeChunks(chunks, &MeshChunk::vertices, mesh->vertices);
+    mergeChunks(chunks, &MeshChunk::normals, mesh->normals);
+    mergeChunks(chunks, &MeshChunk::textureCoordinates, mesh->textureCoordinates);
+
+    return mesh;
+}
+TriangleMesh * TriangleMesh::loadBinary(const char * data, size_t size) {
+    MeshHeader header;
+
+    if (!isBinaryMesh(data, size))
+        return nullptr;
+
+    std::memcpy(&header, data, sizeof(MeshHeader));
+
+    if (header.version != BINARY_VERSION || header.headerSize != getHeaderSize())
+        return nullptr;
+
+    uint64_t offsets[7];
+
+    if (!getBlockOffsets(header.counts, offsets, size))
+        return nullptr;
+
+    // The blocks are copied out, so the mapping is not shared past the load.
+    TriangleMesh * mesh = new TriangleMesh();
+
+    readBlock(data + offsets[0], header.counts[0], mesh->vertices);
+    readBlock(data + offsets[1], header.counts[1], mesh->normals);
+    readBlock(data + offsets[2], header.counts[2], mesh->textureCoordinates);
+    readIndices(data + offsets[3], header.counts[3], mesh->vertexIndices);
+    readIndices(data + offsets[4], header.counts[4], mesh->normalIndices);
+    readIndices(data + offsets[5], header.counts[5], mesh->textureIndices);
+
+    return mesh;
+}
+
+TriangleMesh * TriangleMesh::loadMesh(
+    const std::string & filename, const std::string & cacheDirectory) {
+    MappedFile file(filename);
+
+    if (!file.isOpen())
+        return nullptr;
+
+    if (isBinaryMesh(file.getData(), file.getSize()))
+        return loadBinary(file.getData(), file.getSize());
+
+    uint64_t sourceSize;
+    int64_t sourceTime;
+
+    if (cacheDirectory.empty() || !getFileStamp(filename, sourceSize, sourceTime))
+        return loadObj(file.getData(), file.getSize());
+
+    std::string binaryFilename = getCachePath(cacheDirectory, filename);
+    MappedFile binaryFile(binaryFilename);
+
+    if (binaryFile.isOpen() && isSourceCurrent(
+        binaryFile.getData(), binaryFile.getSize(), sourceSize, sourceTime)) {
+        TriangleMesh * mesh = loadBinary(binaryFile.getData(), binaryFile.getSize());
+
+        if (mesh)
+            return mesh;
+    }
+
+    TriangleMesh * mesh = loadObj(file.getData(), file.getSize());
+    mesh->writeMesh(binaryFilename, sourceSize, sourceTime);
+
+    return mesh;
+}
+
+TriangleMesh::TriangleMesh() : transformation(1.0f), normalTransformation(1.0f) {}
 TriangleMesh::TriangleMesh(const TriangleMesh & triangleMesh) {
     create(triangleMesh);
 }
@@ -263,6 +848,28 @@ bool TriangleMesh::hasTextureCoordinates() const {
     return !textureIndices.empty();
 }
 
+TriangleMesh & TriangleMesh::setTransformation(const glm::mat4 & transformation) {
+    this->transformation = transformation;
+    normalTransformation = glm::transpose(glm::inverse(glm::mat3(transformation)));
+
+    return *this;
+}
+const glm::mat4 & TriangleMesh::getTransformation() const {
+    return transformation;
+}
+const glm::mat3 & TriangleMesh::getNormalTransformation() const {
+    return normalTransformation;
+}
+glm::vec3 TriangleMesh::getTransformedVertex(size_t i) const {
+    return glm::vec3(transformation * glm::vec4(vertices[i], 1.0f));
+}
+glm::vec3 TriangleMesh::getTransformedNormal(size_t i) const {
+    return glm::normalize(normalTransformation * normals[i]);
+}
+bool TriangleMesh::hasTransformation() const {
+    return transformation != glm::mat4(1.0f);
+}
+
 TriangleMesh & TriangleMesh::create(const TriangleMesh & triangleMesh) {
     vertices = triangleMesh.vertices;
     normals = triangleMesh.normals;
@@ -270,6 +877,8 @@ TriangleMesh & TriangleMesh::create(const TriangleMesh & triangleMesh) {
     vertexIndices = triangleMesh.vertexIndices;
     normalIndices = triangleMesh.normalIndices;
     textureIndices = triangleMesh.textureIndices;
+    transformation = triangleMesh.transformation;
+    normalTransformation = triangleMesh.normalTransformation;
 
     return *this;
 }
@@ -293,7 +902,7 @@ TriangleMesh & TriangleMesh::create(
     normalIndices.resize(normalCount ? size : 0);
     textureIndices.resize(textureCoordinateCount ? size : 0);
 
-    return *this;
+    return setTransformation(glm::mat4(1.0f));
 }
 TriangleMesh & TriangleMesh::create(
     const std::vector<glm::vec3> & vertices,
@@ -306,7 +915,7 @@ TriangleMesh & TriangleMesh::create(
     normalIndices.clear();
     textureIndices.clear();
 
-    return *this;
+    return setTransformation(glm::mat4(1.0f));
 }
 TriangleMesh & TriangleMesh::create(
     const std::vector<glm::vec3> & vertices,
@@ -321,7 +930,7 @@ TriangleMesh & TriangleMesh::create(
     textureCoordinates.clear();
     textureIndices.clear();
 
-    return *this;
+    return setTransformation(glm::mat4(1.0f));
 }
 TriangleMesh & TriangleMesh::create(
     const std::vector<glm::vec3> & vertices,
@@ -337,21 +946,87 @@ TriangleMesh & TriangleMesh::create(
     this->normalIndices = normalIndices;
     this->textureIndices = textureIndices;
 
-    return *this;
+    return setTransformation(glm::mat4(1.0f));
 }
 
-TriangleMesh & TriangleMesh::transform(const glm::mat4 & transformation) {
-    for (size_t i = 0; i < getVertexCount(); i++)
-        vertices[i] = transformation * glm::vec4(vertices[i], 1.0);
+TriangleMesh & TriangleMesh::transform(const glm::mat4 & transformation, bool deferred) {
+    setTransformation(transformation * this->transformation);
+
+    return deferred ? *this : applyTransformation();
+}
+TriangleMesh & TriangleMesh::applyTransformation() {
+    if (!hasTransformation())
+        return *this;
+
+    transformPoints(transformation, 1.0f, false, vertices.data(), vertices.size());
+
+    glm::mat4 normalMatrix(normalTransformation);
+    transformPoints(normalMatrix, 0.0f, true, normals.data(), normals.size());
+
+    return setTransformation(glm::mat4(1.0f));
+}
+
+bool TriangleMesh::writeMesh(
+    const std::string & filename, uint64_t sourceSize, int64_t sourceTime) const {
+    MeshHeader header;
+    std::memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+
+    header.version = BINARY_VERSION;
+    header.headerSize = (uint32_t)getHeaderSize();
+    header.counts[0] = vertices.size();
+    header.counts[1] = normals.size();
+    header.counts[2] = textureCoordinates.size();
+    header.counts[3] = vertexIndices.size();
+    header.counts[4] = normalIndices.size();
+    header.counts[5] = textureIndices.size();
+    header.sourceSize = sourceSize;
+    header.sourceTime = sourceTime;
+
+    uint64_t offsets[7];
+    getBlockOffsets(header.counts, offsets, std::numeric_limits<uint64_t>::max());
+
+    std::random_device device;
+    std::ostringstream temporaryFilename;
+    temporaryFilename << filename << '.' << std::hex << device() << device() << ".tmp";
 
-    if (hasNormals()) {
-        glm::mat4 normalTransformation = glm::transpose(glm::inverse(transformation));
+    std::ofstream file(temporaryFilename.str(), std::ofstream::out | std::ofstream::binary);
 
-        for (size_t i = 0; i < getNormalCount(); i++)
-            normals[i] = glm::normalize(normalTransformation * glm::vec4(normals[i], 1.0));
+    if (!file.is_open())
+        return false;
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(MeshHeader));
+
+    writeBlock(file, offsets[0], vertices);
+    writeBlock(file, offsets[1], normals);
+    writeBlock(file, offsets[2], textureCoordinates);
+    writeIndices(file, offsets[3], vertexIndices);
+    writeIndices(file, offsets[4], normalIndices);
+    writeIndices(file, offsets[5], textureIndices);
+    writePadding(file, offsets[6]);
+
+    file.close();
+
+    if (!file) {
+        std::remove(temporaryFilename.str().c_str());
+        return false;
     }
 
-    return *this;
+    if (std::rename(temporaryFilename.str().c_str(), filename.c_str()) != 0) {
+        std::remove(filename.c_str());
+
+        if (std::rename(temporaryFilename.str().c_str(), filename.c_str()) != 0) {
+            std::remove(temporaryFilename.str().c_str());
+            return false;
+        }
+    }
+
+    return true;
+}
+bool TriangleMesh::saveMesh(const std::string & filename) const {
+    if (hasTransformation())
+        return TriangleMesh(*this).applyTransformation().saveMesh(filename);
+
+    return writeMesh(filename, 0, 0);
 }
 
 MPM_NAMESPACE_END
\ No newline at end of file
@@ -56,10 +56,12 @@ Viewer & Viewer::initialize() {
     camera.defaultView();
 
     TriangleMesh * mesh = TriangleMesh::loadMesh("res/meshes/bunny.obj");
+    mesh->transform(glm::translate(glm::mat4(1.0), glm::vec3(0, 4.0, 0)));
+
     Material material(glm::vec3(0, 0, 0), 0.01, 1.0e5, 0.2);
 
     MeshToParticle particleGenerator(mesh, material, 0.1, 1.0, 1.0, 0);
-    std::vector<Particle *> & particles = particleGenerator.getParticles();
+    solver.addParticles(particleGenerator.getParticles());
 
     delete mesh;
 
@@ -76,6 +78,9 @@ Viewer & Viewer::initialize() {
     return *this;
 }
 Viewer & Viewer::render() {
+    if (simulation)
+        solver.advance(1.0 / 60.0);
+
     camera.update();
 
     clearBuffer();
@@ -336,6 +341,9 @@ void Viewer::keyboard(GLFWwindow * window, int key, int code, int action, int mo
         case GLFW_KEY_G:
             viewer->grid = !viewer->grid;
             break;
+        case GLFW_KEY_SPACE:
+            viewer->simulation = !viewer->simulation;
+            break;
         case GLFW_KEY_ESCAPE:
             glfwSetWindowShouldClose(viewer->window, GLFW_TRUE);
             break;
@@ -379,7 +387,7 @@ void Viewer::scroll(GLFWwindow * window, double dx, double dy) {
     camera.move(0, 0, 5.0 * (dx + dy));
 }
 
-Viewer::Viewer() : grid(true) {}
+Viewer::Viewer() : grid(true), simulation(false) {}
 Viewer::Viewer(const std::string & title, size_t width, size_t height) {
     this->title = title;
 
@@ -387,6 +395,7 @@ Viewer::Viewer(const std::string & title, size_t width, size_t height) {
     this->height = height;
 
     this->grid = true;
+    this->simulation = false;
 }
 Viewer::~Viewer() {
     close();
@@ -408,6 +417,10 @@ Viewer & Viewer::setGrid(bool enabled) {
     this->grid = enabled;
     return *this;
 }
+Viewer & Viewer::setSimulation(bool enabled) {
+    this->simulation = enabled;
+    return *this;
+}
 
 const std::string & Viewer::getTitle() const {
     return title;
@@ -421,6 +434,9 @@ size_t Viewer::getWidth() const {
 bool Viewer::getGrid() const {
     return grid;
 }
+bool Viewer::getSimulation() const {
+    return simulation;
+}
 
 Viewer & Viewer::show() {
     mouseState.button = -1;
@@ -0,0 +1,226 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <mpm/VolumeCache.h>
+
+#include <openvdb/io/File.h>
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <random>
+#include <cstdio>
+#include <cstring>
+
+MPM_NAMESPACE_BEGIN
+
+static const uint64_t HASH_PRIME = 0x100000001b3;
+static const uint32_t POINTS_MAGIC = 0x5050504d;
+static const uint32_t POINTS_VERSION = 2;
+
+static uint64_t mix(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccd;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+static std::string getTemporaryPath(const std::string & path) {
+    std::random_device device;
+    std::ostringstream temporaryPath;
+    temporaryPath << path << '.' << std::hex << device() << device() << ".tmp";
+
+    return temporaryPath.str();
+}
+static bool commit(const std::string & temporaryPath, const std::string & path) {
+    if (std::rename(temporaryPath.c_str(), path.c_str()) == 0)
+        return true;
+
+    std::remove(temporaryPath.c_str());
+
+    return false;
+}
+
+uint64_t VolumeCache::computeHash(const void * data, size_t size, uint64_t hash) {
+    const unsigned char * bytes = static_cast<const unsigned char *>(data);
+    size_t words = size / sizeof(uint64_t);
+
+    for (size_t i = 0; i < words; i++) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i * sizeof(uint64_t), sizeof(uint64_t));
+
+        hash = (hash ^ word) * HASH_PRIME;
+    }
+
+    for (size_t i = words * sizeof(uint64_t); i < size; i++)
+        hash = (hash ^ bytes[i]) * HASH_PRIME;
+
+    return mix(hash ^ size);
+}
+uint64_t VolumeCache::computeHash(const TriangleMesh & mesh, uint64_t hash) {
+    const std::vector<glm::vec3> & vertices = mesh.getVertices();
+    const std::vector<size_t> & vertexIndices = mesh.getVertexIndices();
+
+    // Indices are hashed at a fixed width so keys agree across platforms.
+    std::vector<uint64_t> indices(vertexIndices.begin(), vertexIndices.end());
+
+    hash = computeHash(vertices.data(), vertices.size() * sizeof(glm::vec3), hash);
+    hash = computeHash(indices.data(), indices.size() * sizeof(uint64_t), hash);
+    hash = computeHash(&mesh.getTransformation(), sizeof(glm::mat4), hash);
+
+    return hash;
+}
+
+VolumeCache::VolumeCache(const std::string & directory) {
+    this->directory = directory;
+    openvdb::initialize();
+}
+VolumeCache::~VolumeCache() {}
+
+std::string VolumeCache::getPath(uint64_t key, const std::string & extension) const {
+    std::ostringstream path;
+    path << directory << '/' << std::hex << std::setw(16) << std::setfill('0') << key << extension;
+
+    return path.str();
+}
+
+openvdb::FloatGrid::Ptr VolumeCache::loadVolume(uint64_t key) const {
+    std::string path = getPath(key, ".vdb");
+
+    if (!std::ifstream(path).good())
+        return nullptr;
+
+    try {
+        openvdb::io::File file(path);
+        file.open();
+
+        openvdb::GridPtrVecPtr grids = file.getGrids();
+        file.close();
+
+        if (grids->empty())
+            return nullptr;
+
+        return openvdb::gridPtrCast<openvdb::FloatGrid>(grids->front());
+    }
+    catch (const openvdb::Exception &) {
+        return nullptr;
+    }
+}
+bool VolumeCache::saveVolume(uint64_t key, openvdb::FloatGrid::ConstPtr grid) const {
+    std::string path = getPath(key, ".vdb");
+    std::string temporaryPath = getTemporaryPath(path);
+
+    try {
+        openvdb::GridCPtrVec grids;
+        grids.push_back(grid);
+
+        openvdb::io::File file(temporaryPath);
+        file.write(grids);
+        file.close();
+    }
+    catch (const openvdb::Exception &) {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+
+    return commit(temporaryPath, path);
+}
+bool VolumeCache::loadPoints(uint64_t key, std::vector<glm::vec3> & points, float & volume) const {
+    std::ifstream file(getPath(key, ".points"), std::ifstream::in | std::ifstream::binary);
+
+    if (!file.is_open())
+        return false;
+
+    uint32_t magic = 0, version = 0;
+    uint64_t count = 0;
+
+    file.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+    file.read(reinterpret_cast<char *>(&version), sizeof(version));
+    file.read(reinterpret_cast<char *>(&count), sizeof(count));
+    file.read(reinterpret_cast<char *>(&volume), sizeof(volume));
+
+    if (!file || magic != POINTS_MAGIC || version != POINTS_VERSION)
+        return false;
+
+    std::streamoff offset = file.tellg();
+    file.seekg(0, std::ifstream::end);
+    std::streamoff size = file.tellg();
+    file.seekg(offset);
+
+    if (!file || size < offset)
+        return false;
+
+    uint64_t remaining = (uint64_t)(size - offset);
+
+    if (remaining % sizeof(glm::vec3) != 0 || remaining / sizeof(glm::vec3) != count)
+        return false;
+
+    points.resize(count);
+    file.read(reinterpret_cast<char *>(points.data()), count * sizeof(glm::vec3));
+
+    if (!file) {
+        points.clear();
+        return false;
+    }
+
+    return true;
+}
+bool VolumeCache::savePoints(
+    uint64_t key, const std::vector<glm::vec3> & points, float volume) const {
+    std::string path = getPath(key, ".points");
+    std::string temporaryPath = getTemporaryPath(path);
+
+    std::ofstream file(temporaryPath, std::ofstream::out | std::ofstream::binary);
+
+    if (!file.is_open())
+        return false;
+
+    uint64_t count = points.size();
+
+    file.write(reinterpret_cast<const char *>(&POINTS_MAGIC), sizeof(POINTS_MAGIC));
+    file.write(reinterpret_cast<const char *>(&POINTS_VERSION), sizeof(POINTS_VERSION));
+    file.write(reinterpret_cast<const char *>(&count), sizeof(count));
+    file.write(reinterpret_cast<const char *>(&volume), sizeof(volume));
+    file.write(reinterpret_cast<const char *>(points.data()), count * sizeof(glm::vec3));
+    file.close();
+
+    if (!file) {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+
+    return commit(temporaryPath, path);
+}
+
+const std::string & VolumeCache::getDirectory() const {
+    return directory;
+}
+
+MPM_NAMESPACE_END
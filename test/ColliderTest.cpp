@@ -0,0 +1,74 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Test.h"
+#include "Meshes.h"
+
+#include <mpm/Collider.h>
+
+#include <cmath>
+
+MPM_NAMESPACE_BEGIN
+
+MPM_TEST(testColliderUpdate) {
+    const float voxelSize = 0.01f;
+
+    TriangleMesh mesh = createSphere(glm::vec3(0.5f), 0.3f, 24, 32);
+    Collider collider(&mesh, voxelSize);
+
+    for (size_t i = 0; i < mesh.getVertexCount(); i++) {
+        glm::vec3 vertex = mesh.getVertex(i);
+
+        if (vertex.y > 0.75f)
+            mesh.setVertex(i, vertex + glm::vec3(0.5f * voxelSize, 0.0f, 0.0f));
+    }
+
+    // Only the cap moved, so update() touches a few leaves in place instead
+    // of rebuilding the whole volume.
+    openvdb::FloatGrid::ConstPtr volume = collider.getVolume();
+    collider.update(&mesh, 0.1f * voxelSize);
+
+    MPM_CHECK(collider.getVolume() == volume);
+
+    Collider expected(&mesh, voxelSize);
+    openvdb::FloatGrid::ConstAccessor accessor = collider.getVolume()->getConstAccessor();
+    size_t count = 0;
+
+    for (auto iterator = expected.getVolume()->cbeginValueOn(); iterator; ++iterator) {
+        float value = iterator.getValue();
+
+        if (std::abs(value) > 2.0f * voxelSize)
+            continue;
+
+        MPM_CHECK(std::abs(accessor.getValue(iterator.getCoord()) - value) < 0.1f * voxelSize);
+        count++;
+    }
+
+    MPM_CHECK(count > 0);
+}
+
+MPM_NAMESPACE_END
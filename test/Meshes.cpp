@@ -0,0 +1,104 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Meshes.h"
+
+#include <vector>
+#include <cmath>
+
+MPM_NAMESPACE_BEGIN
+
+TriangleMesh createBox(const glm::vec3 & lower, const glm::vec3 & upper) {
+    std::vector<glm::vec3> vertices;
+
+    for (int i = 0; i < 8; i++) {
+        vertices.push_back(glm::vec3(
+            i & 1 ? upper.x : lower.x, i & 2 ? upper.y : lower.y, i & 4 ? upper.z : lower.z));
+    }
+
+    // Two outward facing triangles per side, split along alternating
+    // diagonals so both kinds of shared edge appear.
+    std::vector<size_t> indices = {
+        0, 4, 6, 0, 6, 2,
+        1, 3, 7, 1, 7, 5,
+        0, 1, 5, 0, 5, 4,
+        2, 6, 3, 3, 6, 7,
+        0, 2, 1, 1, 2, 3,
+        4, 5, 7, 4, 7, 6
+    };
+
+    return TriangleMesh(vertices, indices);
+}
+TriangleMesh createSphere(const glm::vec3 & center, float radius, int rings, int segments) {
+    std::vector<glm::vec3> vertices;
+    std::vector<size_t> indices;
+
+    vertices.push_back(center + glm::vec3(0.0f, radius, 0.0f));
+
+    for (int i = 1; i < rings; i++) {
+        float theta = (float)M_PI * i / rings;
+
+        for (int j = 0; j < segments; j++) {
+            float phi = 2.0f * (float)M_PI * j / segments;
+
+            vertices.push_back(center + radius * glm::vec3(
+                std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)));
+        }
+    }
+
+    vertices.push_back(center - glm::vec3(0.0f, radius, 0.0f));
+
+    size_t last = vertices.size() - 1;
+
+    for (int j = 0; j < segments; j++) {
+        size_t a = 1 + j;
+        size_t b = 1 + (j + 1) % segments;
+
+        indices.insert(indices.end(), {0, b, a});
+    }
+
+    for (int i = 0; i < rings - 2; i++) {
+        for (int j = 0; j < segments; j++) {
+            size_t a = 1 + i * segments + j;
+            size_t b = 1 + i * segments + (j + 1) % segments;
+
+            indices.insert(indices.end(), {a, b, b + segments});
+            indices.insert(indices.end(), {a, b + segments, a + segments});
+        }
+    }
+
+    for (int j = 0; j < segments; j++) {
+        size_t a = last - segments + j;
+        size_t b = last - segments + (j + 1) % segments;
+
+        indices.insert(indices.end(), {a, b, last});
+    }
+
+    return TriangleMesh(vertices, indices);
+}
+
+MPM_NAMESPACE_END
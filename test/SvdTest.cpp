@@ -0,0 +1,416 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Test.h"
+
+#include <mpm/Constitutive.h>
+#include <mpm/Kernel.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <cmath>
+
+MPM_NAMESPACE_BEGIN
+
+static const InstructionSet INSTRUCTION_SETS[3] = {
+    InstructionSet::Scalar, InstructionSet::Avx2, InstructionSet::Avx512};
+static const double SVD_TOLERANCE = 1.0e-4;
+static const double STRESS_TOLERANCE = 1.0e-3;
+
+class Matrix {
+public:
+    double values[3][3];
+
+    Matrix() {
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++)
+                values[i][j] = i == j ? 1.0 : 0.0;
+        }
+    }
+    Matrix(double x, double y, double z) : Matrix() {
+        values[0][0] = x;
+        values[1][1] = y;
+        values[2][2] = z;
+    }
+
+    double * operator[](int i) {
+        return values[i];
+    }
+    const double * operator[](int i) const {
+        return values[i];
+    }
+};
+
+class SvdResult {
+public:
+    Matrix u;
+    double sigma[3];
+    Matrix v;
+};
+
+static Matrix multiply(const Matrix & a, const Matrix & b) {
+    Matrix c;
+
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++)
+            c[i][j] = a[i][0] * b[0][j] + a[i][1] * b[1][j] + a[i][2] * b[2][j];
+    }
+
+    return c;
+}
+static Matrix transpose(const Matrix & a) {
+    Matrix b;
+
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++)
+            b[i][j] = a[j][i];
+    }
+
+    return b;
+}
+static Matrix invert(const Matrix & a, double determinant) {
+    Matrix b;
+
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            int i1 = (j + 1) % 3, i2 = (j + 2) % 3;
+            int j1 = (i + 1) % 3, j2 = (i + 2) % 3;
+
+            b[i][j] = (a[i1][j1] * a[i2][j2] - a[i1][j2] * a[i2][j1]) / determinant;
+        }
+    }
+
+    return b;
+}
+static double getDeterminant(const Matrix & a) {
+    return a[0][0] * (a[1][1] * a[2][2] - a[1][2] * a[2][1])
+        - a[0][1] * (a[1][0] * a[2][2] - a[1][2] * a[2][0])
+        + a[0][2] * (a[1][0] * a[2][1] - a[1][1] * a[2][0]);
+}
+static double getNorm(const Matrix & a) {
+    double norm = 0.0;
+
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++)
+            norm += a[i][j] * a[i][j];
+    }
+
+    return std::sqrt(norm);
+}
+static double getDistance(const Matrix & a, const Matrix & b) {
+    double distance = 0.0;
+
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++)
+            distance = std::max(distance, std::abs(a[i][j] - b[i][j]));
+    }
+
+    return distance;
+}
+static Matrix getRotation(std::mt19937 & generator) {
+    std::normal_distribution<double> distribution;
+
+    double q[4];
+    double length = 0.0;
+
+    for (int i = 0; i < 4; i++) {
+        q[i] = distribution(generator);
+        length += q[i] * q[i];
+    }
+
+    for (int i = 0; i < 4; i++)
+        q[i] /= std::sqrt(length);
+
+    Matrix r;
+
+    r[0][0] = 1.0 - 2.0 * (q[1] * q[1] + q[2] * q[2]);
+    r[0][1] = 2.0 * (q[0] * q[1] - q[2] * q[3]);
+    r[0][2] = 2.0 * (q[0] * q[2] + q[1] * q[3]);
+    r[1][0] = 2.0 * (q[0] * q[1] + q[2] * q[3]);
+    r[1][1] = 1.0 - 2.0 * (q[0] * q[0] + q[2] * q[2]);
+    r[1][2] = 2.0 * (q[1] * q[2] - q[0] * q[3]);
+    r[2][0] = 2.0 * (q[0] * q[2] - q[1] * q[3]);
+    r[2][1] = 2.0 * (q[1] * q[2] + q[0] * q[3]);
+    r[2][2] = 1.0 - 2.0 * (q[0] * q[0] + q[1] * q[1]);
+
+    return r;
+}
+
+static std::vector<Matrix> getMatrices() {
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<double> uniform(-2.0, 2.0);
+
+    std::vector<Matrix> matrices;
+
+    matrices.push_back(Matrix());
+    matrices.push_back(Matrix(0.0, 0.0, 0.0));
+    matrices.push_back(Matrix(2.0, 2.0, 2.0));
+    matrices.push_back(Matrix(3.0, 1.0, 0.0));
+    matrices.push_back(Matrix(1.0, 1.0, -1.0));
+    matrices.push_back(Matrix(-1.0, -1.0, -1.0));
+    matrices.push_back(Matrix(0.5, -2.0, 1.0));
+    matrices.push_back(Matrix(1.0e-4, 1.0, 1.0));
+
+    Matrix rank;
+
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++)
+            rank[i][j] = (i + 1.0) * (2.0 - j);
+    }
+
+    matrices.push_back(rank);
+
+    for (int i = 0; i < 8; i++) {
+        Matrix a = getRotation(generator);
+        Matrix b = getRotation(generator);
+
+        matrices.push_back(multiply(multiply(a, Matrix(1.5, 1.5, 0.5)), b));
+        matrices.push_back(multiply(multiply(a, Matrix(2.0, 0.0, 0.0)), b));
+        matrices.push_back(multiply(multiply(a, Matrix(1.2, 0.9, -0.7)), b));
+    }
+
+    for (int i = 0; i < 50; i++) {
+        Matrix a;
+
+        for (int j = 0; j < 3; j++) {
+            for (int k = 0; k < 3; k++)
+                a[j][k] = uniform(generator);
+        }
+
+        matrices.push_back(a);
+    }
+
+    for (int i = 0; i < 20; i++) {
+        Matrix a;
+
+        for (int j = 0; j < 3; j++) {
+            for (int k = 0; k < 3; k++)
+                a[j][k] += 0.2 * uniform(generator);
+        }
+
+        matrices.push_back(multiply(getRotation(generator), a));
+    }
+
+    return matrices;
+}
+
+static void computeSvds(const std::vector<Matrix> & matrices, std::vector<SvdResult> & results) {
+    SvdBatch batch;
+    results.resize(matrices.size());
+
+    for (size_t first = 0; first < matrices.size(); first += KERNEL_BATCH_SIZE) {
+        size_t count = std::min(matrices.size() - first, KERNEL_BATCH_SIZE);
+
+        for (size_t q = 0; q < count; q++) {
+            for (int i = 0; i < 9; i++)
+                batch.matrices[i][q] = (float)matrices[first + q][i % 3][i / 3];
+        }
+
+        Constitutive::computeSvd(batch, count);
+
+        for (size_t q = 0; q < count; q++) {
+            SvdResult & result = results[first + q];
+
+            for (int i = 0; i < 9; i++) {
+                result.u[i % 3][i / 3] = batch.u[i][q];
+                result.v[i % 3][i / 3] = batch.v[i][q];
+            }
+
+            for (int i = 0; i < 3; i++)
+                result.sigma[i] = batch.sigma[i][q];
+        }
+    }
+}
+static void computeStresses(ConstitutiveModel model,
+    const std::vector<Matrix> & matrices, std::vector<Matrix> & stresses) {
+    StressBatch batch;
+    stresses.resize(matrices.size());
+
+    for (size_t first = 0; first < matrices.size(); first += KERNEL_BATCH_SIZE) {
+        size_t count = std::min(matrices.size() - first, KERNEL_BATCH_SIZE);
+
+        for (size_t q = 0; q < count; q++) {
+            for (int i = 0; i < 9; i++)
+                batch.deformationGradients[i][q] = (float)matrices[first + q][i % 3][i / 3];
+
+            batch.lambdas[q] = 2.0f;
+            batch.mus[q] = 1.0f;
+        }
+
+        Constitutive::computeStresses(model, batch, count);
+
+        for (size_t q = 0; q < count; q++) {
+            for (int i = 0; i < 9; i++)
+                stresses[first + q][i % 3][i / 3] = batch.stresses[i][q];
+        }
+    }
+}
+
+static Matrix getReferenceStress(ConstitutiveModel model, const Matrix & f) {
+    double determinant = getDeterminant(f);
+    Matrix stress;
+
+    if (model == ConstitutiveModel::NeoHookean) {
+        stress = multiply(f, transpose(f));
+
+        for (int i = 0; i < 3; i++)
+            stress[i][i] += 2.0 * std::log(determinant) - 1.0;
+
+        return stress;
+    }
+
+    // Newton iterations for the polar decomposition converge to the
+    // rotation whenever the determinant is positive.
+    Matrix rotation = f;
+
+    for (int iteration = 0; iteration < 64; iteration++) {
+        Matrix inverse = transpose(invert(rotation, getDeterminant(rotation)));
+
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++)
+                rotation[i][j] = 0.5 * (rotation[i][j] + inverse[i][j]);
+        }
+    }
+
+    Matrix difference;
+
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++)
+            difference[i][j] = 2.0 * (f[i][j] - rotation[i][j]);
+    }
+
+    stress = multiply(difference, transpose(f));
+
+    for (int i = 0; i < 3; i++)
+        stress[i][i] += 2.0 * (determinant - 1.0) * determinant;
+
+    return stress;
+}
+
+MPM_TEST(testSvdDecomposition) {
+    std::vector<Matrix> matrices = getMatrices();
+    std::vector<SvdResult> reference;
+
+    InstructionSet previous = Kernel::getInstructionSet();
+
+    for (InstructionSet instructionSet : INSTRUCTION_SETS) {
+        if (Kernel::setInstructionSet(instructionSet) != instructionSet)
+            continue;
+
+        std::vector<SvdResult> results;
+        computeSvds(matrices, results);
+
+        if (instructionSet == InstructionSet::Scalar)
+            reference = results;
+
+        for (size_t i = 0; i < matrices.size(); i++) {
+            const Matrix & f = matrices[i];
+            const SvdResult & result = results[i];
+
+            double scale = std::max(getNorm(f), 1.0);
+            const double * sigma = result.sigma;
+
+            Matrix product = multiply(
+                multiply(result.u, Matrix(sigma[0], sigma[1], sigma[2])), transpose(result.v));
+
+            MPM_CHECK(getDistance(product, f) < SVD_TOLERANCE * scale);
+            MPM_CHECK(getDistance(multiply(transpose(result.u), result.u), Matrix()) < SVD_TOLERANCE);
+            MPM_CHECK(getDistance(multiply(transpose(result.v), result.v), Matrix()) < SVD_TOLERANCE);
+            MPM_CHECK(std::abs(getDeterminant(result.u) - 1.0) < SVD_TOLERANCE);
+            MPM_CHECK(std::abs(getDeterminant(result.v) - 1.0) < SVD_TOLERANCE);
+
+            MPM_CHECK(sigma[0] >= sigma[1] - SVD_TOLERANCE * scale);
+            MPM_CHECK(sigma[1] >= std::abs(sigma[2]) - SVD_TOLERANCE * scale);
+
+            double determinant = getDeterminant(f);
+
+            if (std::abs(determinant) > SVD_TOLERANCE * scale * scale * scale)
+                MPM_CHECK((sigma[2] < 0.0) == (determinant < 0.0));
+
+            if (reference.empty())
+                continue;
+
+            for (int j = 0; j < 3; j++)
+                MPM_CHECK(std::abs(sigma[j] - reference[i].sigma[j]) < SVD_TOLERANCE * scale);
+        }
+    }
+
+    Kernel::setInstructionSet(previous);
+}
+MPM_TEST(testStresses) {
+    const ConstitutiveModel models[2] = {
+        ConstitutiveModel::NeoHookean, ConstitutiveModel::FixedCorotated};
+
+    std::vector<Matrix> matrices = getMatrices();
+    std::vector<SvdResult> svds;
+
+    InstructionSet previous = Kernel::getInstructionSet();
+
+    Kernel::setInstructionSet(InstructionSet::Scalar);
+    computeSvds(matrices, svds);
+
+    for (ConstitutiveModel model : models) {
+        std::vector<Matrix> reference;
+
+        for (InstructionSet instructionSet : INSTRUCTION_SETS) {
+            if (Kernel::setInstructionSet(instructionSet) != instructionSet)
+                continue;
+
+            std::vector<Matrix> stresses;
+            computeStresses(model, matrices, stresses);
+
+            if (instructionSet == InstructionSet::Scalar)
+                reference = stresses;
+
+            for (size_t i = 0; i < matrices.size(); i++) {
+                double scale = std::max(getNorm(matrices[i]), 1.0);
+                scale *= scale * scale;
+
+                double determinant = getDeterminant(matrices[i]);
+
+                if (determinant > 0.1) {
+                    Matrix expected = getReferenceStress(model, matrices[i]);
+                    MPM_CHECK(getDistance(stresses[i], expected) < STRESS_TOLERANCE * scale);
+                }
+
+                // Inverted elements whose two smallest singular values match
+                // have no unique closest rotation, so lanes may disagree there.
+                const double * sigma = svds[i].sigma;
+                bool unique = model == ConstitutiveModel::NeoHookean
+                    || determinant > 0.1 || sigma[1] - std::abs(sigma[2]) > 0.1;
+
+                if (unique)
+                    MPM_CHECK(getDistance(stresses[i], reference[i]) < STRESS_TOLERANCE * scale);
+            }
+        }
+    }
+
+    Kernel::setInstructionSet(previous);
+}
+
+MPM_NAMESPACE_END
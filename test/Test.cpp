@@ -0,0 +1,79 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Test.h"
+
+#include <cstdio>
+#include <cstring>
+
+MPM_NAMESPACE_BEGIN
+
+Test::Test(const char * name, Function function) : name(name), function(function) {
+    getTests().push_back(this);
+}
+
+bool Test::check(bool condition, const char * expression, const char * file, int line) {
+    if (!condition) {
+        std::printf("%s:%d: check failed: %s\n", file, line, expression);
+        getFailureCount()++;
+    }
+
+    return condition;
+}
+int Test::run(const char * filter) {
+    size_t testCount = 0;
+    size_t failedCount = 0;
+
+    for (const Test * test : getTests()) {
+        if (filter && !std::strstr(test->name, filter))
+            continue;
+
+        size_t failures = getFailureCount();
+        test->function();
+
+        bool passed = getFailureCount() == failures;
+        std::printf("[%s] %s\n", passed ? "PASS" : "FAIL", test->name);
+
+        testCount++;
+        failedCount += passed ? 0 : 1;
+    }
+
+    std::printf("%zu of %zu tests passed\n", testCount - failedCount, testCount);
+
+    return failedCount == 0 ? 0 : 1;
+}
+
+std::vector<const Test *> & Test::getTests() {
+    static std::vector<const Test *> tests;
+    return tests;
+}
+size_t & Test::getFailureCount() {
+    static size_t failureCount = 0;
+    return failureCount;
+}
+
+MPM_NAMESPACE_END
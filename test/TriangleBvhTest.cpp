@@ -0,0 +1,268 @@
+// Copyright (c) 2019, Danilo Peixoto and Heitor Toledo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Test.h"
+#include "Meshes.h"
+
+#include <mpm/TriangleBvh.h>
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+#include <cmath>
+
+MPM_NAMESPACE_BEGIN
+
+static const float DISTANCE_TOLERANCE = 1.0e-5f;
+
+static glm::dvec3 getClosestSegmentPoint(const glm::dvec3 & a, const glm::dvec3 & b, const glm::dvec3 & point) {
+    glm::dvec3 ab = b - a;
+    double t = glm::clamp(glm::dot(point - a, ab) / glm::dot(ab, ab), 0.0, 1.0);
+
+    return a + ab * t;
+}
+static double getTriangleDistance(const TriangleMesh & mesh, size_t triangle, const glm::vec3 & point) {
+    size_t v0, v1, v2;
+    mesh.getVertexIndices(triangle, v0, v1, v2);
+
+    glm::dvec3 a(mesh.getVertex(v0)), b(mesh.getVertex(v1)), c(mesh.getVertex(v2));
+    glm::dvec3 p(point);
+    glm::dvec3 normal = glm::normalize(glm::cross(b - a, c - a));
+    glm::dvec3 projection = p - normal * glm::dot(p - a, normal);
+
+    bool inside = glm::dot(glm::cross(b - a, projection - a), normal) >= 0.0
+        && glm::dot(glm::cross(c - b, projection - b), normal) >= 0.0
+        && glm::dot(glm::cross(a - c, projection - c), normal) >= 0.0;
+
+    if (inside)
+        return glm::length(p - projection);
+
+    double distance = glm::length(p - getClosestSegmentPoint(a, b, p));
+    distance = std::min(distance, glm::length(p - getClosestSegmentPoint(b, c, p)));
+    distance = std::min(distance, glm::length(p - getClosestSegmentPoint(c, a, p)));
+
+    return distance;
+}
+static double getBruteForceDistance(const TriangleMesh & mesh, const glm::vec3 & point) {
+    double distance = std::numeric_limits<double>::infinity();
+
+    for (size_t i = 0; i < mesh.getTriangleCount(); i++)
+        distance = std::min(distance, getTriangleDistance(mesh, i, point));
+
+    return distance;
+}
+static bool isBruteForceInside(const TriangleMesh & mesh, const glm::vec3 & point) {
+    const glm::dvec3 direction(0.3128, 0.7713, 0.5542);
+    glm::dvec3 origin(point);
+    size_t count = 0;
+
+    for (size_t i = 0; i < mesh.getTriangleCount(); i++) {
+        size_t v0, v1, v2;
+        mesh.getVertexIndices(i, v0, v1, v2);
+
+        glm::dvec3 a(mesh.getVertex(v0)), b(mesh.getVertex(v1)), c(mesh.getVertex(v2));
+        glm::dvec3 ab = b - a, ac = c - a;
+        glm::dvec3 p = glm::cross(direction, ac);
+        double determinant = glm::dot(ab, p);
+
+        if (std::abs(determinant) < 1.0e-12)
+            continue;
+
+        glm::dvec3 offset = origin - a;
+        double u = glm::dot(offset, p) / determinant;
+        glm::dvec3 q = glm::cross(offset, ab);
+        double v = glm::dot(direction, q) / determinant;
+        double t = glm::dot(ac, q) / determinant;
+
+        if (u >= 0.0 && v >= 0.0 && u + v <= 1.0 && t > 0.0)
+            count++;
+    }
+
+    return count & 1;
+}
+static std::vector<glm::vec3> getPoints(size_t count, const glm::vec3 & lower, const glm::vec3 & upper) {
+    std::mt19937 generator(11);
+    std::uniform_real_distribution<float> distribution;
+    std::vector<glm::vec3> points;
+
+    for (size_t i = 0; i < count; i++) {
+        glm::vec3 t(distribution(generator), distribution(generator), distribution(generator));
+        points.push_back(lower + (upper - lower) * t);
+    }
+
+    return points;
+}
+static TriangleMesh createBumpySphere() {
+    TriangleMesh mesh = createSphere(glm::vec3(0.5f), 0.3f, 16, 24);
+
+    for (size_t i = 0; i < mesh.getVertexCount(); i++) {
+        glm::vec3 offset = mesh.getVertex(i) - glm::vec3(0.5f);
+        float scale = 1.0f + 0.2f * std::sin(7.0f * offset.x) * std::cos(5.0f * offset.z);
+
+        mesh.setVertex(i, glm::vec3(0.5f) + offset * scale);
+    }
+
+    return mesh;
+}
+static void deform(TriangleMesh & mesh, float amount, float height) {
+    for (size_t i = 0; i < mesh.getVertexCount(); i++) {
+        glm::vec3 vertex = mesh.getVertex(i);
+
+        if (vertex.y < height)
+            continue;
+
+        float angle = amount * (vertex.y - 0.5f);
+        glm::vec3 offset = vertex - glm::vec3(0.5f);
+
+        vertex.x = 0.5f + offset.x * std::cos(angle) - offset.z * std::sin(angle);
+        vertex.z = 0.5f + offset.x * std::sin(angle) + offset.z * std::cos(angle);
+        vertex.y += 0.1f * amount * offset.x;
+
+        mesh.setVertex(i, vertex);
+    }
+}
+static void checkQueries(const TriangleBvh & bvh, const TriangleBvh & expected) {
+    for (const glm::vec3 & point : getPoints(500, glm::vec3(-0.1f), glm::vec3(1.1f))) {
+        glm::vec3 closest, expectedClosest;
+        size_t triangle, expectedTriangle;
+
+        float distance = bvh.getClosestPoint(point, closest, triangle);
+        float expectedDistance = expected.getClosestPoint(point, expectedClosest, expectedTriangle);
+
+        MPM_CHECK(std::abs(distance - expectedDistance) < DISTANCE_TOLERANCE);
+        MPM_CHECK(bvh.isInside(point) == expected.isInside(point));
+    }
+}
+
+MPM_TEST(testCubeParity) {
+    TriangleBvh bvh(createBox(glm::vec3(0.0f), glm::vec3(1.0f)));
+
+    // Every ray starts off the side planes and steps by whole multiples of
+    // half the cube, so each one crosses the surface exactly at edges and
+    // corners shared by several triangles.
+    const float coordinates[3] = {-0.5f, 0.5f, 1.5f};
+
+    for (float x : coordinates) {
+        for (float y : coordinates) {
+            for (float z : coordinates) {
+                glm::vec3 origin(x, y, z);
+                bool inside = x == 0.5f && y == 0.5f && z == 0.5f;
+
+                for (int i = 0; i < 27; i++) {
+                    glm::vec3 direction(i % 3 - 1, i / 3 % 3 - 1, i / 9 - 1);
+
+                    if (direction == glm::vec3(0.0f))
+                        continue;
+
+                    MPM_CHECK((bvh.countIntersections(origin, direction) & 1) == (inside ? 1 : 0));
+                }
+
+                MPM_CHECK(bvh.isInside(origin) == inside);
+            }
+        }
+    }
+}
+MPM_TEST(testClosestPoint) {
+    TriangleMesh mesh = createBumpySphere();
+    TriangleBvh bvh(mesh);
+
+    for (const glm::vec3 & point : getPoints(500, glm::vec3(-0.2f), glm::vec3(1.2f))) {
+        glm::vec3 closest;
+        size_t triangle;
+
+        float distance = bvh.getClosestPoint(point, closest, triangle);
+        double expected = getBruteForceDistance(mesh, point);
+
+        MPM_CHECK(std::abs(distance - expected) < DISTANCE_TOLERANCE);
+        MPM_CHECK(std::abs(glm::length(closest - point) - distance) < DISTANCE_TOLERANCE);
+        MPM_CHECK(std::abs(getTriangleDistance(mesh, triangle, point) - expected) < DISTANCE_TOLERANCE);
+    }
+}
+MPM_TEST(testSignedDistance) {
+    TriangleMesh mesh = createBumpySphere();
+    TriangleBvh bvh(mesh);
+
+    for (const glm::vec3 & point : getPoints(500, glm::vec3(0.0f), glm::vec3(1.0f))) {
+        double expected = getBruteForceDistance(mesh, point);
+
+        // Parity is only meaningful away from the surface itself.
+        if (expected < 1.0e-3)
+            continue;
+
+        if (isBruteForceInside(mesh, point))
+            expected = -expected;
+
+        MPM_CHECK(std::abs(bvh.getSignedDistance(point) - expected) < DISTANCE_TOLERANCE);
+    }
+}
+MPM_TEST(testRefit) {
+    TriangleMesh mesh = createBumpySphere();
+    TriangleBvh bvh(mesh);
+
+    deform(mesh, 2.0f, 0.0f);
+    bvh.refit(mesh);
+    checkQueries(bvh, TriangleBvh(mesh));
+}
+MPM_TEST(testPartialRefit) {
+    TriangleMesh mesh = createBumpySphere();
+    TriangleBvh bvh(mesh);
+
+    std::vector<glm::vec3> vertices = mesh.getVertices();
+    deform(mesh, 2.0f, 0.6f);
+
+    std::vector<uint32_t> dirty;
+
+    for (size_t i = 0; i < mesh.getTriangleCount(); i++) {
+        size_t v0, v1, v2;
+        mesh.getVertexIndices(i, v0, v1, v2);
+
+        if (mesh.getVertex(v0) != vertices[v0] || mesh.getVertex(v1) != vertices[v1]
+            || mesh.getVertex(v2) != vertices[v2])
+            dirty.push_back((uint32_t)i);
+    }
+
+    MPM_CHECK(!dirty.empty() && dirty.size() < mesh.getTriangleCount());
+
+    TriangleBvh full = bvh;
+    full.refit(mesh);
+    bvh.refit(mesh, dirty);
+
+    const std::vector<TriangleBvh::Node> & nodes = bvh.getNodes();
+    const std::vector<TriangleBvh::Node> & expected = full.getNodes();
+
+    MPM_CHECK(nodes.size() == expected.size());
+
+    for (size_t i = 0; i < std::min(nodes.size(), expected.size()); i++)
+        MPM_CHECK(nodes[i].lower == expected[i].lower && nodes[i].upper == expected[i].upper);
+
+    checkQueries(bvh, TriangleBvh(mesh));
+}
+
+MPM_NAMESPACE_END